@@ -0,0 +1,114 @@
+#pragma once
+
+#include "_external.hh"
+
+namespace funcc::parser {
+	// Allocator for objects that live during one parse. Small blocks are bumped out of large chunks and recycled
+	// through free lists by size class, nothing goes back to the system before the arena is destroyed. Every object
+	// allocated here must be gone by then.
+	class Arena {
+	public:
+		constexpr static size_t ChunkSize = 64 * 1024;
+		constexpr static size_t Granularity = 16;
+		constexpr static size_t MaxPooledSize = 256;
+
+	private:
+		std::vector<std::unique_ptr<std::byte[]>> m_chunks{};
+		std::byte* m_current{nullptr};
+		size_t m_left{0};
+		std::array<void*, MaxPooledSize / Granularity + 1> m_free{};
+		size_t m_allocated{0};
+
+	public:
+		Arena() = default;
+
+		Arena(Arena const&) = delete;
+		Arena& operator=(Arena const&) = delete;
+
+		~Arena() = default;
+
+		void* Allocate(size_t size, size_t alignment) {
+			if (!IsPooled(size, alignment)) {
+				return Bump(size, alignment);
+			}
+			size_t sizeClass = (size + Granularity - 1) / Granularity;
+			if (void* block = m_free[sizeClass]) {
+				m_free[sizeClass] = *static_cast<void**>(block);
+				return block;
+			}
+			return Bump(sizeClass * Granularity, Granularity);
+		}
+
+		void Deallocate(void* block, size_t size, size_t alignment) {
+			if (!IsPooled(size, alignment)) {
+				return;
+			}
+			size_t sizeClass = (size + Granularity - 1) / Granularity;
+			*static_cast<void**>(block) = m_free[sizeClass];
+			m_free[sizeClass] = block;
+		}
+
+		// bytes taken from the chunks so far
+		[[nodiscard]] size_t GetAllocated() const {
+			return m_allocated;
+		}
+
+	private:
+		[[nodiscard]] static bool IsPooled(size_t size, size_t alignment) {
+			return size <= MaxPooledSize && alignment <= Granularity;
+		}
+
+		void* Bump(size_t size, size_t alignment) {
+			size_t padding = (alignment - reinterpret_cast<uintptr_t>(m_current) % alignment) % alignment;
+			if (padding + size > m_left) {
+				// oversized requests get a chunk of their own
+				size_t chunkSize = std::max(ChunkSize, size + alignment);
+				m_chunks.push_back(std::make_unique<std::byte[]>(chunkSize));
+				m_current = m_chunks.back().get();
+				m_left = chunkSize;
+				padding = (alignment - reinterpret_cast<uintptr_t>(m_current) % alignment) % alignment;
+			}
+			void* block = m_current + padding;
+			m_current += padding + size;
+			m_left -= padding + size;
+			m_allocated += padding + size;
+			return block;
+		}
+	};
+
+	template<typename T>
+	class ArenaAllocator {
+		Arena* m_arena;
+
+		template<typename U>
+		friend class ArenaAllocator;
+
+	public:
+		using value_type = T;
+
+		explicit ArenaAllocator(Arena& arena) :
+			m_arena{&arena} {}
+
+		template<typename U>
+		ArenaAllocator(ArenaAllocator<U> const& other) :
+			m_arena{other.m_arena} {}
+
+		T* allocate(size_t n) {
+			return static_cast<T*>(m_arena->Allocate(n * sizeof(T), alignof(T)));
+		}
+
+		void deallocate(T* block, size_t n) {
+			m_arena->Deallocate(block, n * sizeof(T), alignof(T));
+		}
+
+		template<typename U>
+		bool operator==(ArenaAllocator<U> const& other) const {
+			return m_arena == other.m_arena;
+		}
+
+		template<typename U>
+		bool operator!=(ArenaAllocator<U> const& other) const {
+			return m_arena != other.m_arena;
+		}
+	};
+}
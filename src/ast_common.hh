@@ -1,5 +1,6 @@
 #pragma once
 #include "_external.hh"
+#include "symbol_table.hh"
 
 // TODO: make it configurable in runtime
 #ifndef TChar
@@ -7,7 +8,7 @@
 #endif
 
 #ifndef TInt
-#define TInt int
+#define TInt int64_t
 #endif
 
 #ifndef TFloat
@@ -19,22 +20,30 @@
 #endif
 
 namespace funcc {
-	using Identifier = std::string;
-	using QualifiedIdentifier = std::string;
-	using InfixIdentifier = std::string;
-	using FullIdentifier = std::string;
-
+	// names are interned, ASTs compare and hash them as integers
+	using Identifier = Symbol;
+	using QualifiedIdentifier = Symbol;
+	using InfixIdentifier = Symbol;
+	using FullIdentifier = Symbol;
+
+	// id a SourceManager gives a source, NoFile for text that was not registered
+	using FileId = uint32_t;
+	constexpr FileId NoFile = 0;
+
+	// Byte offset into a source, sources are limited to 4 GiB. The SourceManager resolves it to a line and column
+	// for diagnostics.
 	struct Location {
-		size_t position;
-		size_t line;
-		size_t column;
+		uint32_t position;
+		FileId file;
 
 		Location() = default;
 
-		Location(size_t position, size_t line, size_t column) :
-			position(position),
-			line(line),
-			column(column) {}
+		// the SourceManager rejects sources too large for the offset to fit
+		explicit Location(size_t position, FileId file = NoFile) :
+			position(static_cast<uint32_t>(position)),
+			file(file) {
+			assert(position <= UINT32_MAX);
+		}
 
 		Location(Location const& other) = default;
 		Location& operator=(Location const& other) = default;
@@ -70,6 +79,31 @@ namespace funcc {
 		}
 	};
 
+	// Range as the AST stores it, with one file id for both ends. Parser ranges convert to it implicitly.
+	struct SourceRange {
+		FileId file;
+		uint32_t begin;
+		uint32_t end;
+
+		SourceRange() = default;
+
+		SourceRange(Range const& range) :
+			file{range.start.file},
+			begin{range.start.position},
+			end{range.end.position} {}
+
+		SourceRange(SourceRange const& other) = default;
+		SourceRange& operator=(SourceRange const& other) = default;
+
+		[[nodiscard]] Location GetStart() const {
+			return Location{begin, file};
+		}
+
+		[[nodiscard]] Location GetEnd() const {
+			return Location{end, file};
+		}
+	};
+
 	class IConst {
 	public:
 		virtual ~IConst() = default;
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "_external.hh"
+
+namespace funcc {
+	// A package in one file: an index of its modules followed by their sources back to back. Integers are little
+	// endian and unaligned.
+	//
+	//   magic "FUNCCBN1"
+	//   u32 module count
+	//   per module: u32 name length, name, u64 offset of the source from the start of the file, u64 length,
+	//               u64 Hash of the source
+	//   sources
+	//
+	// Modules are named by the path of their source relative to the package root, with '/' separators.
+	class Bundle {
+	public:
+		constexpr static std::string_view Magic = "FUNCCBN1";
+
+		struct Module {
+			// a view into the bundle
+			std::string_view name;
+			uint64_t offset;
+			uint64_t length;
+			uint64_t hash;
+		};
+
+		// 64 bit FNV-1a
+		[[nodiscard]] static uint64_t Hash(std::string_view text) {
+			uint64_t hash = 0xCBF29CE484222325;
+			for (char c: text) {
+				hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001B3;
+			}
+			return hash;
+		}
+
+		// false if the data is not a bundle or an entry reaches past its end
+		static bool ReadIndex(std::string_view data, std::vector<Module>& outModules) {
+			outModules.clear();
+			if (data.substr(0, Magic.size()) != Magic) {
+				return false;
+			}
+			size_t at = Magic.size();
+			uint64_t count = 0;
+			if (!Get(data, at, 4, count)) {
+				return false;
+			}
+			for (uint64_t i = 0; i < count; ++i) {
+				uint64_t nameLength = 0;
+				Module module{};
+				if (!Get(data, at, 4, nameLength) || nameLength > data.size() - at) {
+					return false;
+				}
+				module.name = data.substr(at, nameLength);
+				at += nameLength;
+				if (!Get(data, at, 8, module.offset) || !Get(data, at, 8, module.length) ||
+					!Get(data, at, 8, module.hash)) {
+					return false;
+				}
+				if (module.offset > data.size() || module.length > data.size() - module.offset) {
+					return false;
+				}
+				outModules.push_back(module);
+			}
+			return true;
+		}
+
+		// writes the sources in the given order, false if the file cannot be written
+		static bool Write(
+			std::string const& path,
+			std::vector<std::pair<std::string, std::string_view>> const& modules
+		) {
+			size_t indexSize = Magic.size() + 4;
+			for (auto const& [name, source]: modules) {
+				indexSize += 4 + name.size() + 3 * 8;
+			}
+
+			std::string index{Magic};
+			Put(index, 4, modules.size());
+			uint64_t offset = indexSize;
+			for (auto const& [name, source]: modules) {
+				Put(index, 4, name.size());
+				index += name;
+				Put(index, 8, offset);
+				Put(index, 8, source.size());
+				Put(index, 8, Hash(source));
+				offset += source.size();
+			}
+
+			std::ofstream stream{path, std::ios::binary | std::ios::trunc};
+			stream.write(index.data(), static_cast<std::streamsize>(index.size()));
+			for (auto const& [name, source]: modules) {
+				stream.write(source.data(), static_cast<std::streamsize>(source.size()));
+			}
+			return stream.good();
+		}
+
+	private:
+		static void Put(std::string& out, size_t bytes, uint64_t value) {
+			for (size_t i = 0; i < bytes; ++i) {
+				out += static_cast<char>((value >> (8 * i)) & 0xFF);
+			}
+		}
+
+		static bool Get(std::string_view data, size_t& at, size_t bytes, uint64_t& outValue) {
+			if (bytes > data.size() - at) {
+				return false;
+			}
+			outValue = 0;
+			for (size_t i = 0; i < bytes; ++i) {
+				outValue |= uint64_t{static_cast<unsigned char>(data[at + i])} << (8 * i);
+			}
+			at += bytes;
+			return true;
+		}
+	};
+}
@@ -0,0 +1,553 @@
+#pragma once
+
+#include "_external.hh"
+#include "parser.hh"
+
+// Grammar nodes composed by type instead of through IToken pointers. A node is a plain object holding its parts by
+// value and calling them directly, so a whole grammar compiles into functions the compiler can inline into each
+// other, without virtual calls or std::function in between. The leaves are the tokens of the dynamic grammar, shared
+// with it and with the lexer, and called without virtual dispatch.
+//
+// Every node has the same two members as a token:
+//   Result Consume(IReader& reader, ParseContext& context) const;
+//   void CollectFirst(FirstSet& first, std::vector<void const*>& visiting) const;
+namespace funcc::parser::fixed {
+	using Result = std::shared_ptr<ITokenValue>;
+
+	// stands for an absent part of a node
+	struct None {};
+
+	template<typename N>
+	inline constexpr bool IsNone = std::is_same_v<N, None>;
+
+	// used by skipWs()
+	inline static void SkipTrivia(IToken const& trivia, IReader& reader, ParseContext& context) {
+		IToken::SkipTrivia(trivia, reader, context);
+	}
+
+	template<typename T>
+	class TokenNode {
+		std::shared_ptr<T> m_token;
+
+	public:
+		explicit TokenNode(std::shared_ptr<T> token) :
+			m_token{std::move(token)} {}
+
+		// qualified calls are bound at compile time
+		Result Consume(IReader& reader, ParseContext& context) const {
+			return m_token->T::Consume(reader, context);
+		}
+
+		void CollectFirst(FirstSet& first, std::vector<void const*>& visiting) const {
+			m_token->T::CollectFirst(first, visiting);
+		}
+	};
+
+	// the token itself is used, so the lexer still recognizes it
+	template<typename T>
+	inline static TokenNode<T> Use(std::shared_ptr<IToken> const& token) {
+		return TokenNode<T>{std::dynamic_pointer_cast<T>(token)};
+	}
+
+	inline static TokenNode<ExactToken> Exact(std::string_view target, std::shared_ptr<IToken> ignoreWS) {
+		return TokenNode<ExactToken>{std::make_shared<ExactToken>(target, std::move(ignoreWS))};
+	}
+
+	template<typename... Ns>
+	class AllNode {
+		std::tuple<Ns...> m_nodes;
+
+	public:
+		explicit AllNode(Ns... nodes) :
+			m_nodes{std::move(nodes)...} {}
+
+		Result Consume(IReader& reader, ParseContext& context) const {
+			return IToken::Memoize(this, reader, context, [this, &reader, &context]() -> Result {
+				Location start = reader.GetLocation();
+
+				std::vector<Result> results{};
+				results.reserve(sizeof...(Ns));
+				Result failure{};
+
+				auto consume = [&reader, &context, &results, &failure](auto const& node) {
+					Result result = node.Consume(reader, context);
+					if (!result->HasValue()) {
+						failure = std::move(result);
+						return false;
+					}
+					if (AllToken::FilterIgnored(result)) {
+						results.push_back(std::move(result));
+					}
+					return true;
+				};
+
+				auto consumeAll = [&consume](auto const&... nodes) { return (consume(nodes) && ...); };
+				if (!std::apply(consumeAll, m_nodes)) {
+					reader.SetLocation(start);
+					return failure;
+				}
+				return IToken::Make<MultiValue>(context, start, reader, std::move(results));
+			});
+		}
+
+		void CollectFirst(FirstSet& first, std::vector<void const*>& visiting) const {
+			auto collect = [&first, &visiting](auto const& node) {
+				FirstSet item{};
+				node.CollectFirst(item, visiting);
+				first.chars |= item.chars;
+				return item.nullable;
+			};
+
+			if (std::apply([&collect](auto const&... nodes) { return (collect(nodes) && ...); }, m_nodes)) {
+				first.nullable = true;
+			}
+		}
+	};
+
+	template<typename... Ns>
+	inline static AllNode<Ns...> All(Ns... nodes) {
+		return AllNode<Ns...>{std::move(nodes)...};
+	}
+
+	template<typename... Ns>
+	class OneOfNode {
+		static_assert(sizeof...(Ns) <= 64, "the alternatives a character can start are kept in a 64 bit mask");
+
+		// alternatives that can start with each character, filled on first use like FirstDispatch
+		struct Dispatch {
+			std::once_flag once{};
+			std::array<uint64_t, 256> candidates{};
+		};
+
+		std::tuple<Ns...> m_nodes;
+		std::shared_ptr<IToken> m_ignoreWS;
+		// copies have the same alternatives, so they share the table
+		std::shared_ptr<Dispatch> m_dispatch{std::make_shared<Dispatch>()};
+
+	public:
+		explicit OneOfNode(std::shared_ptr<IToken> ignoreWS, Ns... nodes) :
+			m_nodes{std::move(nodes)...},
+			m_ignoreWS{std::move(ignoreWS)} {}
+
+		Result Consume(IReader& reader, ParseContext& context) const {
+			return IToken::Memoize(this, reader, context, [this, &reader, &context]() {
+				Location start = reader.GetLocation();
+				skipWs();
+
+				Result result = ConsumeChoice(reader, context);
+				if (result && result->HasValue()) {
+					return result;
+				}
+				// alternatives that were tried recorded their own failures, ones at this position take precedence
+				return IToken::RewindWithError(start, reader, context, FailureKind::UnexpectedCharacter);
+			});
+		}
+
+		// The first alternative matching at the reader, otherwise the failure of the last one tried. Null when none
+		// can start at the reader.
+		Result ConsumeChoice(IReader& reader, ParseContext& context) const {
+			uint64_t candidates = ~uint64_t{0};
+			// alternatives skip the same trivia, so the current character is the one they start with
+			if (m_ignoreWS) {
+				std::call_once(m_dispatch->once, [this]() { Build(); });
+				candidates = m_dispatch->candidates[FirstSet::Slot(reader.GetChar())];
+			}
+			return ConsumeCandidates(candidates, reader, context, std::index_sequence_for<Ns...>{});
+		}
+
+		void CollectFirst(FirstSet& first, std::vector<void const*>& visiting) const {
+			auto collectAll = [&first, &visiting](auto const&... nodes) { (nodes.CollectFirst(first, visiting), ...); };
+			std::apply(collectAll, m_nodes);
+		}
+
+		[[nodiscard]] IToken const* GetTrivia() const {
+			return m_ignoreWS.get();
+		}
+
+	private:
+		template<size_t... Is>
+		Result ConsumeCandidates(
+			uint64_t candidates,
+			IReader& reader,
+			ParseContext& context,
+			std::index_sequence<Is...>
+		) const {
+			Result result{};
+			// tried in order, the first match stops the fold
+			auto attempt = [&result, &reader, &context](auto const& node) {
+				result = node.Consume(reader, context);
+				return result->HasValue();
+			};
+			(void) ((((candidates >> Is) & 1) && attempt(std::get<Is>(m_nodes))) || ...);
+			return result;
+		}
+
+		void Build() const {
+			std::lock_guard<std::mutex> lock{FirstSet::GetCollectMutex()};
+
+			size_t index = 0;
+			auto add = [this, &index](auto const& node) {
+				FirstSet first{};
+				std::vector<void const*> visiting{};
+				node.CollectFirst(first, visiting);
+				for (size_t slot = 0; slot < 256; ++slot) {
+					if (first.nullable || first.chars.test(slot)) {
+						m_dispatch->candidates[slot] |= uint64_t{1} << index;
+					}
+				}
+				index++;
+			};
+			std::apply([&add](auto const&... nodes) { (add(nodes), ...); }, m_nodes);
+		}
+	};
+
+	template<typename... Ns>
+	inline static OneOfNode<Ns...> OneOf(std::shared_ptr<IToken> ignoreWS, Ns... nodes) {
+		return OneOfNode<Ns...>{std::move(ignoreWS), std::move(nodes)...};
+	}
+
+	template<typename N, typename D = None, typename A = None>
+	class OptionalNode {
+		N m_node;
+		D m_dependent;
+		A m_alternative;
+
+	public:
+		explicit OptionalNode(N node, D dependent = {}, A alternative = {}) :
+			m_node{std::move(node)},
+			m_dependent{std::move(dependent)},
+			m_alternative{std::move(alternative)} {}
+
+		Result Consume(IReader& reader, ParseContext& context) const {
+			Location start = reader.GetLocation();
+
+			Result result = m_node.Consume(reader, context);
+			if (result->HasError()) {
+				if constexpr (IsNone<A>) {
+					return OptionalToken::Skipped;
+				} else {
+					Result altValue = m_alternative.Consume(reader, context);
+					if (altValue->HasError()) {
+						reader.SetLocation(start);
+					}
+					return altValue;
+				}
+			}
+			if constexpr (IsNone<D>) {
+				return result;
+			} else {
+				Result value = m_dependent.Consume(reader, context);
+				if (value->HasError()) {
+					reader.SetLocation(start);
+				}
+				return value;
+			}
+		}
+
+		void CollectFirst(FirstSet& first, std::vector<void const*>& visiting) const {
+			FirstSet token{};
+			m_node.CollectFirst(token, visiting);
+			if constexpr (!IsNone<D>) {
+				if (token.nullable) {
+					token.nullable = false;
+					m_dependent.CollectFirst(token, visiting);
+				}
+			}
+			first.chars |= token.chars;
+
+			if constexpr (IsNone<A>) {
+				first.nullable = true;
+			} else {
+				FirstSet alternative{};
+				m_alternative.CollectFirst(alternative, visiting);
+				first.chars |= alternative.chars;
+				first.nullable = first.nullable || token.nullable || alternative.nullable;
+			}
+		}
+	};
+
+	template<typename N, typename D = None, typename A = None>
+	inline static OptionalNode<N, D, A> Optional(N node, D dependent = {}, A alternative = {}) {
+		return OptionalNode<N, D, A>{std::move(node), std::move(dependent), std::move(alternative)};
+	}
+
+	template<typename I, typename P, typename S, typename Sep, typename F>
+	class SomeNode {
+		I m_item;
+		P m_prefix;
+		S m_suffix;
+		Sep m_separator;
+		std::shared_ptr<IToken> m_ignoreWS;
+		F m_firstItem;
+		bool m_allowEmpty;
+		bool m_allowSeparatorBeforeSuffix;
+
+	public:
+		SomeNode(
+			I item,
+			P prefix,
+			S suffix,
+			Sep separator,
+			std::shared_ptr<IToken> ignoreWS,
+			F firstItem,
+			bool allowEmpty,
+			bool allowSeparatorBeforeSuffix
+		) :
+			m_item{std::move(item)},
+			m_prefix{std::move(prefix)},
+			m_suffix{std::move(suffix)},
+			m_separator{std::move(separator)},
+			m_ignoreWS{std::move(ignoreWS)},
+			m_firstItem{std::move(firstItem)},
+			m_allowEmpty{allowEmpty},
+			m_allowSeparatorBeforeSuffix{allowSeparatorBeforeSuffix} {}
+
+		Result Consume(IReader& reader, ParseContext& context) const {
+			Location start = reader.GetLocation();
+			skipWs();
+
+			if constexpr (!IsNone<P>) {
+				Result prefix = m_prefix.Consume(reader, context);
+				if (prefix->HasError()) {
+					reader.SetLocation(start);
+					return prefix;
+				}
+			}
+
+			std::vector<Result> values{};
+			bool first = true;
+			while (true) {
+				skipWs();
+
+				Result separator = m_separator.Consume(reader, context);
+
+				if constexpr (IsNone<S>) {
+					// without a suffix the list ends at the first item that is not followed by a separator
+					if (separator->HasError() && !first) {
+						break;
+					}
+				} else if (separator->HasError() || m_allowSeparatorBeforeSuffix || !first || m_allowEmpty) {
+					skipWs();
+					if (m_suffix.Consume(reader, context)->HasValue()) {
+						break;
+					}
+				}
+
+				skipWs();
+				Result item{};
+				if constexpr (IsNone<F>) {
+					item = m_item.Consume(reader, context);
+				} else {
+					item = first ? m_firstItem.Consume(reader, context) : m_item.Consume(reader, context);
+				}
+				if (item->HasError()) {
+					reader.SetLocation(start);
+					return item;
+				}
+
+				values.push_back(item);
+				first = false;
+			}
+
+			return IToken::Make<MultiValue>(context, start, reader, std::move(values));
+		}
+
+		void CollectFirst(FirstSet& first, std::vector<void const*>& visiting) const {
+			if constexpr (!IsNone<P>) {
+				FirstSet prefix{};
+				m_prefix.CollectFirst(prefix, visiting);
+				first.chars |= prefix.chars;
+				if (!prefix.nullable) {
+					return;
+				}
+			}
+
+			// a leading separator and an immediate suffix are accepted too
+			m_separator.CollectFirst(first, visiting);
+			if constexpr (!IsNone<S>) {
+				m_suffix.CollectFirst(first, visiting);
+			}
+			if constexpr (IsNone<F>) {
+				m_item.CollectFirst(first, visiting);
+			} else {
+				m_firstItem.CollectFirst(first, visiting);
+			}
+			first.nullable = true;
+		}
+	};
+
+	template<typename I, typename P, typename S, typename Sep, typename F = None>
+	inline static SomeNode<I, P, S, Sep, F> Some(
+		I item,
+		P prefix,
+		S suffix,
+		Sep separator,
+		std::shared_ptr<IToken> ignoreWS,
+		F firstItem = {},
+		bool allowEmpty = false,
+		bool allowSeparatorBeforeSuffix = false
+	) {
+		return SomeNode<I, P, S, Sep, F>{
+			std::move(item),
+			std::move(prefix),
+			std::move(suffix),
+			std::move(separator),
+			std::move(ignoreWS),
+			std::move(firstItem),
+			allowEmpty,
+			allowSeparatorBeforeSuffix
+		};
+	}
+
+	template<typename C, typename B>
+	class RepeatNode {
+		C m_condition;
+		B m_body;
+		std::shared_ptr<IToken> m_ignoreWS;
+		bool m_allowEmpty;
+
+	public:
+		RepeatNode(C condition, B body, std::shared_ptr<IToken> ignoreWS, bool allowEmpty) :
+			m_condition{std::move(condition)},
+			m_body{std::move(body)},
+			m_ignoreWS{std::move(ignoreWS)},
+			m_allowEmpty{allowEmpty} {}
+
+		Result Consume(IReader& reader, ParseContext& context) const {
+			Location start = reader.GetLocation();
+			skipWs();
+
+			std::vector<Result> values{};
+			while (true) {
+				Location itemStart = reader.GetLocation();
+				skipWs();
+
+				Result condition = m_condition.Consume(reader, context);
+				reader.SetLocation(itemStart);
+
+				if (condition->HasError()) {
+					if (!m_allowEmpty && values.empty()) {
+						reader.SetLocation(start);
+						return condition;
+					}
+					break;
+				}
+				skipWs();
+				Result body = m_body.Consume(reader, context);
+				if (body->HasError()) {
+					reader.SetLocation(start);
+					return body;
+				}
+				values.push_back(body);
+			}
+			return IToken::Make<MultiValue>(context, start, reader, std::move(values));
+		}
+
+		void CollectFirst(FirstSet& first, std::vector<void const*>& visiting) const {
+			FirstSet condition{};
+			m_condition.CollectFirst(condition, visiting);
+			if (condition.nullable) {
+				m_body.CollectFirst(condition, visiting);
+			}
+			first.chars |= condition.chars;
+			first.nullable = first.nullable || m_allowEmpty || condition.nullable;
+		}
+	};
+
+	template<typename C, typename B>
+	inline static RepeatNode<C, B> Repeat(
+		C condition,
+		B body,
+		std::shared_ptr<IToken> ignoreWS,
+		bool allowEmpty = false
+	) {
+		return RepeatNode<C, B>{std::move(condition), std::move(body), std::move(ignoreWS), allowEmpty};
+	}
+
+	using Mapper = Result (*)(Result const& value);
+
+	template<typename N, Mapper mapper>
+	class MapNode {
+		N m_node;
+
+	public:
+		explicit MapNode(N node) :
+			m_node{std::move(node)} {}
+
+		Result Consume(IReader& reader, ParseContext& context) const {
+			Location start = reader.GetLocation();
+			Result result = m_node.Consume(reader, context);
+			if (result->HasError()) {
+				return result;
+			}
+
+			Result mapped = mapper(result);
+			if (mapped->HasError()) {
+				context.GetFailures().RecordMapped(mapped);
+				reader.SetLocation(start);
+			}
+			return mapped;
+		}
+
+		void CollectFirst(FirstSet& first, std::vector<void const*>& visiting) const {
+			m_node.CollectFirst(first, visiting);
+		}
+	};
+
+	template<Mapper mapper, typename N>
+	inline static MapNode<N, mapper> Map(N node) {
+		return MapNode<N, mapper>{std::move(node)};
+	}
+
+	// A recursive rule, the fixed counterpart of a forward declaration. A node cannot contain itself, so R only
+	// declares `static auto const& Alternatives();` and defines it once the grammar is complete. The alternatives are
+	// a OneOfNode, its trivia is skipped once by the rule.
+	template<typename R>
+	class RuleNode {
+		// shared by every use of the rule, as the members of a forward declaration are
+		inline static char const Key{};
+		inline static size_t const Slot = ParseContext::NewDepthSlot();
+		inline static FirstSet First{};
+		inline static bool FirstDone{false};
+
+	public:
+		Result Consume(IReader& reader, ParseContext& context) const {
+			auto const& alternatives = R::Alternatives();
+			return ForwardDeclarationToken::ConsumeRule(
+				&Key,
+				Slot,
+				alternatives.GetTrivia(),
+				reader,
+				context,
+				[&alternatives, &reader, &context]() { return alternatives.ConsumeChoice(reader, context); }
+			);
+		}
+
+		// grown to a fixed point as in ForwardDeclarationToken::CollectFirst
+		void CollectFirst(FirstSet& first, std::vector<void const*>& visiting) const {
+			if (FirstDone || std::find(visiting.begin(), visiting.end(), &Key) != visiting.end()) {
+				first = first | First;
+				return;
+			}
+
+			visiting.push_back(&Key);
+			while (true) {
+				FirstSet next = First;
+				R::Alternatives().CollectFirst(next, visiting);
+				if (next.chars == First.chars && next.nullable == First.nullable) {
+					break;
+				}
+				First = next;
+			}
+			visiting.pop_back();
+
+			FirstDone = visiting.empty();
+			first = first | First;
+		}
+	};
+
+	template<typename R>
+	inline static RuleNode<R> Rule() {
+		return RuleNode<R>{};
+	}
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "_external.hh"
+#include "parser.hh"
+#include "reader.hh"
+#include "token_stream.hh"
+
+namespace funcc::parser {
+	// Splits a source into lexemes once, before parsing. The trivia token is skipped between lexemes and every rule is
+	// tried at the start of each lexeme; the longest match decides where the next one starts. Rules are ordinary
+	// tokens of the grammar, when the parser consumes the same token object at a lexeme start it takes the result from
+	// the stream. Rules must ignore nothing but the trivia token.
+	class Lexer {
+	public:
+		struct Rule {
+			std::shared_ptr<IToken> token;
+			// give equal lexemes of the rule the same id, for identifiers and operators
+			bool intern;
+		};
+
+	private:
+		std::shared_ptr<IToken> m_trivia;
+		std::vector<Rule> m_rules;
+
+	public:
+		Lexer(std::shared_ptr<IToken> trivia, std::vector<Rule> rules) :
+			m_trivia{std::move(trivia)},
+			m_rules{std::move(rules)} {}
+
+		~Lexer() = default;
+
+		// the source has to be valid UTF-8, ascii tells the reader there is nothing to decode
+		[[nodiscard]] TokenStream Lex(std::string_view source, bool ascii = false) const {
+			std::vector<IToken const*> rules{};
+			for (auto& rule: m_rules) {
+				rules.push_back(rule.token.get());
+			}
+			TokenStream tokens{source, m_trivia.get(), std::move(rules)};
+
+			// a token cannot match at a character outside of its first set, most attempts end here
+			FirstSet trivia = m_trivia->GetFirst();
+			std::vector<FirstSet> firsts{};
+			for (auto& rule: m_rules) {
+				firsts.push_back(rule.token->GetFirst());
+			}
+
+			Utf8Reader reader{source, NoFile, ascii};
+			ParseContext context{};
+			std::vector<uint32_t> matches(m_rules.size());
+
+			while (true) {
+				size_t triviaStart = reader.GetLocation().position;
+				if (trivia.chars.test(FirstSet::Slot(reader.GetChar()))) {
+					m_trivia->Skip(reader, context);
+				}
+				Location start = reader.GetLocation();
+				size_t slot = FirstSet::Slot(reader.GetChar());
+				if (slot == 0) {
+					tokens.SetEnd(triviaStart, start);
+					break;
+				}
+
+				// the rule with the longest match, none for a single character no rule accepts
+				size_t longest = m_rules.size();
+				Location end = start;
+				for (size_t i = 0; i < m_rules.size(); ++i) {
+					if (!firsts[i].chars.test(slot) && !firsts[i].nullable) {
+						matches[i] = TokenStream::NoMatch;
+						continue;
+					}
+					reader.SetLocation(start);
+					if (m_rules[i].token->Consume(reader, context)->HasError()) {
+						matches[i] = TokenStream::NoMatch;
+						continue;
+					}
+					matches[i] = static_cast<uint32_t>(reader.GetLocation().position - start.position);
+					if (end < reader.GetLocation()) {
+						longest = i;
+						end = reader.GetLocation();
+					}
+				}
+
+				reader.SetLocation(start);
+				if (longest == m_rules.size()) {
+					reader.Move();
+				} else {
+					reader.SetLocation(end);
+				}
+
+				uint32_t length = static_cast<uint32_t>(reader.GetLocation().position - start.position);
+				bool intern = longest < m_rules.size() && m_rules[longest].intern;
+				tokens.Push(triviaStart, start, length, matches.data(), intern);
+			}
+
+			return tokens;
+		}
+	};
+}
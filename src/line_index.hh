@@ -0,0 +1,44 @@
+#pragma once
+
+#include "_external.hh"
+#include "ast_common.hh"
+#include "scan.hh"
+
+namespace funcc {
+	struct LineColumn {
+		// both start at 1, the column counts UTF-8 characters
+		size_t line;
+		size_t column;
+	};
+
+	// Start offsets of the lines of a source, built with one newline scan. Locations only carry byte offsets, this
+	// resolves them when a diagnostic needs a line and column. The source must outlive the index.
+	class LineIndex {
+		std::string_view m_source;
+		std::vector<size_t> m_starts{};
+
+	public:
+		explicit LineIndex(std::string_view source) :
+			m_source{source} {
+			m_starts.reserve(Scan::Count(source, '\n') + 1);
+			m_starts.push_back(0);
+			size_t offset = 0;
+			while (true) {
+				offset += Scan::Byte(source.substr(offset), '\n');
+				if (offset == source.size()) {
+					break;
+				}
+				m_starts.push_back(++offset);
+			}
+		}
+
+		~LineIndex() = default;
+
+		[[nodiscard]] LineColumn Resolve(Location location) const {
+			size_t position = std::min<size_t>(location.position, m_source.size());
+			size_t line = std::upper_bound(m_starts.begin(), m_starts.end(), position) - m_starts.begin();
+			size_t start = m_starts[line - 1];
+			return LineColumn{line, 1 + Scan::Characters(m_source.substr(start, position - start))};
+		}
+	};
+}
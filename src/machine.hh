@@ -0,0 +1,302 @@
+#pragma once
+
+#include "_external.hh"
+#include "parser.hh"
+
+namespace funcc::parser {
+	// Runs a Program. Backtracking, rule calls and values under construction are kept on explicit stacks, so the
+	// loop does not recurse and only leaves the instruction array to call leaf tokens and mappers. It matches what the
+	// compiled tokens match, with the same memo entries and recorded failures.
+	class Machine {
+		enum class EntryKind : uint8_t {
+			// resumes at pc with the position and values it saved
+			Choice,
+			// start of a value, see Opcode::Open
+			Capture,
+			// a memoized token being matched, failing records its failure
+			Memo,
+			// a rule being matched, pc is where it returns
+			Rule
+		};
+
+		struct Entry {
+			EntryKind kind;
+			uint32_t pc;
+			// index of the token or rule
+			uint32_t index;
+			// number of values when the entry was pushed
+			size_t values;
+			// position to return to, of the start of the value, or where the memo entry or the rule begins
+			Location location;
+			// last result of a left recursive rule that is growing and where it ends
+			std::shared_ptr<ITokenValue> grown{};
+			Location end{};
+		};
+
+		using Values = std::vector<std::shared_ptr<ITokenValue>>;
+
+		Program m_program;
+
+	public:
+		explicit Machine(Program program) :
+			m_program{std::move(program)} {}
+
+		~Machine() = default;
+
+		std::shared_ptr<ITokenValue> Run(IReader& reader, ParseContext& context) const {
+			std::vector<Instruction> const& code = m_program.code;
+			std::vector<IToken const*> const& tokens = m_program.tokens;
+			MemoTable& memo = context.GetMemoTable();
+
+			std::vector<Entry> stack{};
+			Values values{};
+			uint32_t pc = 0;
+			bool failed = false;
+
+			while (true) {
+				if (failed) {
+					failed = false;
+					if (!Backtrack(reader, context, stack, values, pc)) {
+						return IToken::Failed;
+					}
+				}
+
+				Instruction const& instruction = code[pc];
+				switch (instruction.op) {
+					case Opcode::Jump:
+						pc = instruction.target;
+						break;
+					case Opcode::Choice:
+						stack.push_back(
+							Entry{EntryKind::Choice, instruction.target, 0, values.size(), reader.GetLocation()}
+						);
+						pc++;
+						break;
+					case Opcode::Commit:
+						stack.pop_back();
+						pc = instruction.target;
+						break;
+					case Opcode::BackCommit:
+						reader.SetLocation(stack.back().location);
+						values.resize(stack.back().values);
+						stack.pop_back();
+						pc = instruction.target;
+						break;
+					case Opcode::Fail:
+						failed = true;
+						break;
+					case Opcode::Call: {
+						Program::Rule const& rule = m_program.rules[instruction.arg];
+						// checked before the memo lookup: hitting the limit depends on the caller, not on the input
+						if (context.GetDepth(rule.slot) >= 256) {
+							IToken::RewindWithError(reader.GetLocation(), reader, context, FailureKind::RecursionLimit);
+							failed = true;
+							break;
+						}
+						if (rule.trivia) {
+							IToken::SkipTrivia(*rule.trivia, reader, context);
+						}
+
+						Location start = reader.GetLocation();
+						if (MemoTable::Entry* entry = memo.Find(rule.key, start.position)) {
+							if (entry->pending) {
+								entry->leftRecursive = true;
+							}
+							failed = !Reuse(*entry, reader, values);
+							pc++;
+							break;
+						}
+						// a recursive call that finds the seed fails, see ForwardDeclarationToken::ConsumeGrowing
+						memo.Store(rule.key, start.position, IToken::Failed, start, true);
+
+						context.GetDepth(rule.slot)++;
+						stack.push_back(Entry{EntryKind::Rule, pc + 1, instruction.arg, values.size(), start});
+						pc = rule.body;
+						break;
+					}
+					case Opcode::Return: {
+						Entry& entry = stack.back();
+						Program::Rule const& rule = m_program.rules[entry.index];
+						size_t position = entry.location.position;
+						Location end = reader.GetLocation();
+						bool grows = entry.grown ? entry.end < end : memo.Lookup(rule.key, position)->leftRecursive;
+						if (grows) {
+							// run the alternatives again on top of the longer seed
+							entry.grown = std::move(values.back());
+							entry.end = end;
+							values.pop_back();
+							memo.Store(rule.key, position, entry.grown, end, true);
+							memo.Invalidate(position);
+							reader.SetLocation(entry.location);
+							pc = rule.body;
+							break;
+						}
+						if (entry.grown) {
+							// the last attempt got no further than the seed, which stays
+							values.back() = std::move(entry.grown);
+							reader.SetLocation(entry.end);
+						}
+						memo.Store(rule.key, position, values.back(), reader.GetLocation());
+						context.GetDepth(rule.slot)--;
+						pc = entry.pc;
+						stack.pop_back();
+						break;
+					}
+					case Opcode::MemoEnter: {
+						pc++;
+						Location start = reader.GetLocation();
+						if (MemoTable::Entry* entry = memo.Find(tokens[instruction.arg], start.position)) {
+							failed = !Reuse(*entry, reader, values);
+							pc = instruction.target;
+							break;
+						}
+						stack.push_back(Entry{EntryKind::Memo, 0, instruction.arg, values.size(), start});
+						break;
+					}
+					case Opcode::MemoLeave: {
+						Entry& entry = stack.back();
+						Location end = reader.GetLocation();
+						memo.Store(tokens[entry.index], entry.location.position, values.back(), end);
+						stack.pop_back();
+						pc++;
+						break;
+					}
+					case Opcode::End:
+						return values.back();
+					case Opcode::TestSet:
+						if (m_program.sets[instruction.arg].test(FirstSet::Slot(reader.GetChar()))) {
+							pc++;
+						} else {
+							pc = instruction.target;
+						}
+						break;
+					case Opcode::Literal: {
+						auto const* exact = static_cast<ExactToken const*>(tokens[instruction.arg]);
+						failed = !Push(exact->ExactToken::Consume(reader, context), values);
+						pc++;
+						break;
+					}
+					case Opcode::Token:
+						failed = !Push(tokens[instruction.arg]->Consume(reader, context), values);
+						pc++;
+						break;
+					case Opcode::Trivia:
+						IToken::SkipTrivia(*tokens[instruction.arg], reader, context);
+						pc++;
+						break;
+					case Opcode::Unexpected:
+						context.GetFailures().Record(reader.GetLocation(), FailureKind::UnexpectedCharacter);
+						failed = true;
+						break;
+					case Opcode::Open:
+						stack.push_back(Entry{EntryKind::Capture, 0, 0, values.size(), reader.GetLocation()});
+						pc++;
+						break;
+					case Opcode::CaptureAll:
+					case Opcode::CaptureList: {
+						Entry& entry = stack.back();
+						Values items{};
+						for (size_t i = entry.values; i < values.size(); ++i) {
+							if (instruction.op == Opcode::CaptureList || AllToken::FilterIgnored(values[i])) {
+								items.push_back(std::move(values[i]));
+							}
+						}
+						if (instruction.arg && items.empty()) {
+							failed = true;
+							break;
+						}
+						values.resize(entry.values);
+						values.push_back(IToken::Make<MultiValue>(context, entry.location, reader, std::move(items)));
+						stack.pop_back();
+						pc++;
+						break;
+					}
+					case Opcode::Map: {
+						std::shared_ptr<ITokenValue> mapped = (*m_program.mappers[instruction.arg])(values.back());
+						if (mapped->HasError()) {
+							context.GetFailures().RecordMapped(mapped);
+							failed = true;
+							break;
+						}
+						values.back() = std::move(mapped);
+						pc++;
+						break;
+					}
+					case Opcode::Drop:
+						values.pop_back();
+						pc++;
+						break;
+					case Opcode::Skipped:
+						values.push_back(OptionalToken::Skipped);
+						pc++;
+						break;
+				}
+			}
+		}
+
+	private:
+		static bool Push(std::shared_ptr<ITokenValue> value, Values& values) {
+			if (value->HasError()) {
+				return false;
+			}
+			values.push_back(std::move(value));
+			return true;
+		}
+
+		static bool Reuse(MemoTable::Entry const& entry, IReader& reader, Values& values) {
+			reader.SetLocation(entry.end);
+			return Push(entry.result, values);
+		}
+
+		// Unwinds to the last choice, or to a growing rule that falls back to its seed. Returns false when nothing
+		// is left to try.
+		bool Backtrack(
+			IReader& reader,
+			ParseContext& context,
+			std::vector<Entry>& stack,
+			Values& values,
+			uint32_t& pc
+		) const {
+			MemoTable& memo = context.GetMemoTable();
+			while (!stack.empty()) {
+				Entry& entry = stack.back();
+				switch (entry.kind) {
+					case EntryKind::Choice:
+						reader.SetLocation(entry.location);
+						values.resize(entry.values);
+						pc = entry.pc;
+						stack.pop_back();
+						return true;
+					case EntryKind::Capture:
+						break;
+					case EntryKind::Memo:
+						// the failed token rewound to where it started
+						memo.Store(
+							m_program.tokens[entry.index],
+							entry.location.position,
+							IToken::Failed,
+							entry.location
+						);
+						break;
+					case EntryKind::Rule: {
+						Program::Rule const& rule = m_program.rules[entry.index];
+						context.GetDepth(rule.slot)--;
+						if (entry.grown) {
+							reader.SetLocation(entry.end);
+							values.resize(entry.values);
+							memo.Store(rule.key, entry.location.position, entry.grown, entry.end);
+							values.push_back(std::move(entry.grown));
+							pc = entry.pc;
+							stack.pop_back();
+							return true;
+						}
+						memo.Store(rule.key, entry.location.position, IToken::Failed, entry.location);
+						break;
+					}
+				}
+				stack.pop_back();
+			}
+			return false;
+		}
+	};
+}
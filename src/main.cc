@@ -2,18 +2,83 @@
 #include "nar/parser_package.hh"
 #include "parser.hh"
 
+// parses the files with each engine and prints the average time of a pass over all of them
+static int Bench(std::vector<std::string> const& files) {
+	using Engine = funcc::nar::PackageParser::Engine;
+	constexpr int rounds = 10;
+
+	std::vector<std::pair<Engine, std::string_view>> const engines{
+		{Engine::Tokens, "tokens"},
+		{Engine::Fixed, "fixed"},
+		{Engine::Machine, "machine"},
+	};
+
+	for (auto const& [engine, name]: engines) {
+		funcc::nar::PackageParser p{funcc::parser::MemoTable::DefaultCapacity, engine};
+
+		// the first pass fills the dispatch tables and is not timed
+		for (auto const& file: files) {
+			if (p.ParseFile(file)->HasError()) {
+				std::cerr << "Error: failed to parse " << file << std::endl;
+				return 1;
+			}
+		}
+
+		auto start = std::chrono::steady_clock::now();
+		for (int round = 0; round < rounds; ++round) {
+			for (auto const& file: files) {
+				p.ParseFile(file);
+			}
+		}
+		auto elapsed =
+			std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+		std::cout << name << ": " << elapsed.count() / rounds << " us" << std::endl;
+	}
+	return 0;
+}
+
 int main(int argc, char const* argv[]) {
 	using namespace funcc::parser;
+	if (argc > 1 && std::string_view{argv[1]} == "--bench") {
+		return Bench(std::vector<std::string>(argv + 2, argv + argc));
+	}
+	if (argc > 3 && std::string_view{argv[1]} == "--bundle") {
+		funcc::nar::PackageParser p{};
+		if (std::shared_ptr<ITokenValue> error = p.WriteBundle(argv[2], argv[3])) {
+			std::cerr << "Error: \n" << error->As<ErrorValue>().GetMessage() << std::endl;
+			return 1;
+		}
+		return 0;
+	}
+
+	// a package directory or a bundle, the root defaults to the standard library checked out next to the binary
+	std::string root = argc > 1 ? argv[1] : "tmp/Nar.Base-main/src";
 	funcc::nar::PackageParser p{};
-	std::shared_ptr<ITokenValue> fileResult = p.ParseFile("tmp/Nar.Base-main/src/List.nar");
-	if (fileResult->HasError()) {
-		std::shared_ptr<ErrorValue> error = std::dynamic_pointer_cast<ErrorValue>(fileResult);
-		std::cerr
-			<< "Error: \n"
-			<< "tmp/Nar.Base-main/src/List.nar" << ":" << error->GetRange().start.line << ":"
-			<< error->GetRange().start.column << "  " << error->GetMessage() << std::endl;
+	std::vector<funcc::nar::PackageParser::PackageFile> files =
+		std::filesystem::is_regular_file(root) ? p.ParseBundle(root) : p.ParsePackage(root);
+	bool failed = false;
+	for (auto const& file: files) {
+		if (!file.result->HasError()) {
+			continue;
+		}
+		failed = true;
+		ErrorValue const& error = file.result->As<ErrorValue>();
+		funcc::Location start = error.GetRange().start;
+		std::cerr << "Error: \n";
+		if (start.file == funcc::NoFile) {
+			std::cerr << file.path << "  " << error.GetMessage() << std::endl;
+			continue;
+		}
+		funcc::LineColumn at = p.GetSources().Resolve(start);
+		std::cerr << p.GetSources().GetPath(start.file) << ":" << at.line << ":" << at.column << "  "
+				  << error.GetMessage() << std::endl;
+	}
+	if (failed) {
 		exit(1);
 	}
-	std::cout << "Parsed successfully!" << std::endl;
+	funcc::parser::MemoStats const& memo = p.GetMemoStats();
+	std::cout << "Parsed " << files.size() << " files successfully!" << std::endl;
+	std::cout << "Memo: " << memo.hits << " hits, " << memo.misses << " misses, " << memo.evictions << " evictions"
+			  << std::endl;
 	exit(0);
 }
@@ -4,21 +4,21 @@
 #include "../ast_common.hh"
 
 namespace funcc::nar {
-	using Identifier = std::string_view;
-	using QualifiedIdentifier = std::string_view;
-	using InfixIdentifier = std::string_view;
-	using FullIdentifier = std::string_view;
+	using Identifier = funcc::Identifier;
+	using QualifiedIdentifier = funcc::QualifiedIdentifier;
+	using InfixIdentifier = funcc::InfixIdentifier;
+	using FullIdentifier = funcc::FullIdentifier;
 
 	enum class Associativity { Left = -1, None = 0, Right = 1 };
 
 	class IDeclaration {
-		Range m_range;
+		SourceRange m_range;
 		Identifier m_name;
-		Range m_nameRange;
+		SourceRange m_nameRange;
 		bool m_hidden;
 
 	public:
-		IDeclaration(Range range, Identifier name, Range nameRange, bool hidden) :
+		IDeclaration(SourceRange range, Identifier name, SourceRange nameRange, bool hidden) :
 			m_range{std::move(range)},
 			m_name{std::move(name)},
 			m_nameRange{std::move(nameRange)},
@@ -26,7 +26,7 @@ namespace funcc::nar {
 
 		virtual ~IDeclaration() = default;
 
-		[[nodiscard]] Range const& GetRange() const {
+		[[nodiscard]] SourceRange const& GetRange() const {
 			return m_range;
 		}
 
@@ -34,7 +34,7 @@ namespace funcc::nar {
 			return m_name;
 		}
 
-		[[nodiscard]] Range const& GetNameRange() const {
+		[[nodiscard]] SourceRange const& GetNameRange() const {
 			return m_nameRange;
 		}
 
@@ -44,10 +44,10 @@ namespace funcc::nar {
 	};
 
 	class IType {
-		Range m_range;
+		SourceRange m_range;
 
 	public:
-		IType(Range range) :
+		IType(SourceRange range) :
 			m_range{std::move(range)} {}
 
 		IType(IType const&) = default;
@@ -55,24 +55,24 @@ namespace funcc::nar {
 
 		virtual ~IType() = default;
 
-		[[nodiscard]] Range const& GetRange() const {
+		[[nodiscard]] SourceRange const& GetRange() const {
 			return m_range;
 		}
 
-		// virtual IType ApplyArgs(std::unordered_map<Identifier, IType> const& args, Range const& range) = 0;
+		// virtual IType ApplyArgs(std::unordered_map<Identifier, IType> const& args, SourceRange const& range) = 0;
 	};
 
 	class IExpression {
-		Range m_range;
+		SourceRange m_range;
 
 	public:
-		IExpression(Range range) :
+		IExpression(SourceRange range) :
 			m_range{std::move(range)} {}
 
 		IExpression(IExpression const&) = default;
 		IExpression& operator=(IExpression const&) = default;
 
-		[[nodiscard]] Range const& GetRange() const {
+		[[nodiscard]] SourceRange const& GetRange() const {
 			return m_range;
 		}
 
@@ -81,11 +81,11 @@ namespace funcc::nar {
 
 	class IPattern {
 	private:
-		Range m_range;
+		SourceRange m_range;
 		std::shared_ptr<IType> m_type;
 
 	public:
-		IPattern(Range range, std::shared_ptr<IType> type) :
+		IPattern(SourceRange range, std::shared_ptr<IType> type) :
 			m_range{std::move(range)},
 			m_type{std::move(type)} {}
 
@@ -94,7 +94,7 @@ namespace funcc::nar {
 
 		virtual ~IPattern() = default;
 
-		[[nodiscard]] Range const& GetRange() const {
+		[[nodiscard]] SourceRange const& GetRange() const {
 			return m_range;
 		}
 
@@ -104,22 +104,22 @@ namespace funcc::nar {
 	};
 
 	struct DataConstructorParameter {
-		Range range;
+		SourceRange range;
 		Identifier name;
-		Range nameRange;
+		SourceRange nameRange;
 		std::shared_ptr<IType> type;
 	};
 
 	struct DataConstructor {
-		Range range;
+		SourceRange range;
 		bool hidden;
 		Identifier name;
-		Range nameRange;
+		SourceRange nameRange;
 		std::vector<DataConstructorParameter> params;
 	};
 
 	struct Import {
-		Range range;
+		SourceRange range;
 		QualifiedIdentifier module;
 		Identifier alias;
 		bool exposeAll;
@@ -128,7 +128,7 @@ namespace funcc::nar {
 
 	struct File {
 		QualifiedIdentifier module;
-		Range moduleRange;
+		SourceRange moduleRange;
 		std::vector<Import> imports;
 		std::vector<std::shared_ptr<IDeclaration>> declarations;
 	};
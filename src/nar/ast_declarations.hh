@@ -10,9 +10,9 @@ namespace funcc::nar {
 
 	public:
 		Alias(
-			Range range,
+			SourceRange range,
 			Identifier name,
-			Range nameRange,
+			SourceRange nameRange,
 			bool hidden,
 			std::shared_ptr<IType> type,
 			std::vector<std::shared_ptr<IType>> typeParams
@@ -39,9 +39,9 @@ namespace funcc::nar {
 
 	public:
 		Infix(
-			Range range,
+			SourceRange range,
 			InfixIdentifier name,
-			Range nameRange,
+			SourceRange nameRange,
 			bool hidden,
 			Associativity associativity,
 			int64_t precedence,
@@ -74,9 +74,9 @@ namespace funcc::nar {
 
 	public:
 		Function(
-			Range range,
+			SourceRange range,
 			Identifier name,
-			Range nameRange,
+			SourceRange nameRange,
 			bool hidden,
 			std::vector<std::shared_ptr<IPattern>> params,
 			std::shared_ptr<IType> type,
@@ -108,9 +108,9 @@ namespace funcc::nar {
 
 	public:
 		Data(
-			Range range,
+			SourceRange range,
 			Identifier name,
-			Range nameRange,
+			SourceRange nameRange,
 			bool hidden,
 			std::vector<Identifier> typeParams,
 			std::vector<DataConstructor> constructors
@@ -8,10 +8,15 @@ namespace funcc::nar {
 	class ExpressionAccess final : public IExpression {
 		std::shared_ptr<IExpression> m_record;
 		Identifier m_fieldName;
-		Range m_fieldNameRange;
+		SourceRange m_fieldNameRange;
 
 	public:
-		ExpressionAccess(Range range, std::shared_ptr<IExpression> record, Identifier fieldName, Range fieldNameRange) :
+		ExpressionAccess(
+			SourceRange range,
+			std::shared_ptr<IExpression> record,
+			Identifier fieldName,
+			SourceRange fieldNameRange
+		) :
 			IExpression(std::move(range)),
 			m_record(std::move(record)),
 			m_fieldName(std::move(fieldName)),
@@ -27,7 +32,7 @@ namespace funcc::nar {
 			return m_fieldName;
 		}
 
-		[[nodiscard]] Range const& GetFieldNameRange() const {
+		[[nodiscard]] SourceRange const& GetFieldNameRange() const {
 			return m_fieldNameRange;
 		}
 	};
@@ -36,7 +41,7 @@ namespace funcc::nar {
 		Identifier m_fieldName;
 
 	public:
-		ExpressionAccessor(Range range, Identifier fieldName) :
+		ExpressionAccessor(SourceRange range, Identifier fieldName) :
 			IExpression(std::move(range)),
 			m_fieldName(std::move(fieldName)) {}
 
@@ -53,7 +58,7 @@ namespace funcc::nar {
 
 	public:
 		ExpressionApply(
-			Range range,
+			SourceRange range,
 			std::shared_ptr<IExpression> function,
 			std::vector<std::shared_ptr<IExpression>>&& args
 		) :
@@ -80,7 +85,7 @@ namespace funcc::nar {
 
 	public:
 		ExpressionBinOp(
-			Range range,
+			SourceRange range,
 			std::shared_ptr<IExpression> left,
 			std::shared_ptr<IExpression> op,
 			std::shared_ptr<IExpression> right
@@ -107,14 +112,14 @@ namespace funcc::nar {
 
 	class ExpressionCall final : public IExpression {
 		FullIdentifier m_name;
-		Range m_nameRange;
+		SourceRange m_nameRange;
 		std::vector<std::shared_ptr<IExpression>> m_args;
 
 	public:
 		ExpressionCall(
-			Range range,
+			SourceRange range,
 			FullIdentifier name,
-			Range nameRange,
+			SourceRange nameRange,
 			std::vector<std::shared_ptr<IExpression>>&& args
 		) :
 			IExpression(std::move(range)),
@@ -128,7 +133,7 @@ namespace funcc::nar {
 			return m_name;
 		}
 
-		[[nodiscard]] Range const& GetNameRange() const {
+		[[nodiscard]] SourceRange const& GetNameRange() const {
 			return m_nameRange;
 		}
 
@@ -141,7 +146,7 @@ namespace funcc::nar {
 		std::shared_ptr<IConst> m_value;
 
 	public:
-		ExpressionConst(Range range, std::shared_ptr<IConst> value) :
+		ExpressionConst(SourceRange range, std::shared_ptr<IConst> value) :
 			IExpression(std::move(range)),
 			m_value(std::move(value)) {}
 
@@ -156,16 +161,16 @@ namespace funcc::nar {
 		QualifiedIdentifier m_module;
 		Identifier m_data;
 		Identifier m_option;
-		Range m_nameRange;
+		SourceRange m_nameRange;
 		std::vector<std::shared_ptr<IExpression>> m_args;
 
 	public:
 		ExpressionConstructor(
-			Range range,
+			SourceRange range,
 			QualifiedIdentifier module,
 			Identifier data,
 			Identifier option,
-			Range nameRange,
+			SourceRange nameRange,
 			std::vector<std::shared_ptr<IExpression>>&& args
 		) :
 			IExpression(std::move(range)),
@@ -189,7 +194,7 @@ namespace funcc::nar {
 			return m_option;
 		}
 
-		[[nodiscard]] Range const& GetNameRange() const {
+		[[nodiscard]] SourceRange const& GetNameRange() const {
 			return m_nameRange;
 		}
 
@@ -205,7 +210,7 @@ namespace funcc::nar {
 
 	public:
 		ExpressionIf(
-			Range range,
+			SourceRange range,
 			std::shared_ptr<IExpression> condition,
 			std::shared_ptr<IExpression> trueBranch,
 			std::shared_ptr<IExpression> falseBranch
@@ -234,7 +239,7 @@ namespace funcc::nar {
 		InfixIdentifier m_infix;
 
 	public:
-		ExpressionInfixVar(Range range, InfixIdentifier infix) :
+		ExpressionInfixVar(SourceRange range, InfixIdentifier infix) :
 			IExpression(std::move(range)),
 			m_infix(std::move(infix)) {}
 
@@ -252,7 +257,7 @@ namespace funcc::nar {
 
 	public:
 		ExpressionLambda(
-			Range range,
+			SourceRange range,
 			std::vector<std::shared_ptr<IPattern>>&& params,
 			std::shared_ptr<IType> returnType,
 			std::shared_ptr<IExpression> body
@@ -279,7 +284,7 @@ namespace funcc::nar {
 
 	class ExpressionLetFunction final : public IExpression {
 		Identifier m_name;
-		Range m_nameRange;
+		SourceRange m_nameRange;
 		std::vector<std::shared_ptr<IPattern>> m_params;
 		std::shared_ptr<IType> m_returnType;
 		std::shared_ptr<IExpression> m_body;
@@ -287,9 +292,9 @@ namespace funcc::nar {
 
 	public:
 		ExpressionLetFunction(
-			Range range,
+			SourceRange range,
 			Identifier name,
-			Range nameRange,
+			SourceRange nameRange,
 			std::vector<std::shared_ptr<IPattern>>&& params,
 			std::shared_ptr<IType> returnType,
 			std::shared_ptr<IExpression> body,
@@ -309,7 +314,7 @@ namespace funcc::nar {
 			return m_name;
 		}
 
-		[[nodiscard]] Range const& GetNameRange() const {
+		[[nodiscard]] SourceRange const& GetNameRange() const {
 			return m_nameRange;
 		}
 
@@ -337,7 +342,7 @@ namespace funcc::nar {
 
 	public:
 		ExpressionLetVar(
-			Range range,
+			SourceRange range,
 			std::shared_ptr<IPattern> pattern,
 			std::shared_ptr<IExpression> value,
 			std::shared_ptr<IExpression> nested
@@ -366,7 +371,7 @@ namespace funcc::nar {
 		std::vector<std::shared_ptr<IExpression>> m_expressions;
 
 	public:
-		ExpressionList(Range range, std::vector<std::shared_ptr<IExpression>>&& expressions) :
+		ExpressionList(SourceRange range, std::vector<std::shared_ptr<IExpression>>&& expressions) :
 			IExpression(std::move(range)),
 			m_expressions(std::move(expressions)) {}
 
@@ -381,7 +386,7 @@ namespace funcc::nar {
 		std::shared_ptr<IExpression> m_expression;
 
 	public:
-		ExpressionNegate(Range range, std::shared_ptr<IExpression> expression) :
+		ExpressionNegate(SourceRange range, std::shared_ptr<IExpression> expression) :
 			IExpression(std::move(range)),
 			m_expression(std::move(expression)) {}
 
@@ -395,9 +400,9 @@ namespace funcc::nar {
 	class ExpressionRecord final : public IExpression {
 	public:
 		struct Field {
-			Range range;
+			SourceRange range;
 			Identifier name;
-			Range nameRange;
+			SourceRange nameRange;
 			std::shared_ptr<IExpression> value;
 		};
 
@@ -405,7 +410,7 @@ namespace funcc::nar {
 		std::vector<Field> m_fields;
 
 	public:
-		ExpressionRecord(Range range, std::vector<Field>&& fields) :
+		ExpressionRecord(SourceRange range, std::vector<Field>&& fields) :
 			IExpression(std::move(range)),
 			m_fields(std::move(fields)) {}
 
@@ -419,7 +424,7 @@ namespace funcc::nar {
 	class ExpressionSelect final : public IExpression {
 	public:
 		struct Case {
-			Range range;
+			SourceRange range;
 			std::shared_ptr<IPattern> pattern;
 			std::shared_ptr<IExpression> expression;
 		};
@@ -430,7 +435,7 @@ namespace funcc::nar {
 		std::vector<Case> m_cases;
 
 	public:
-		ExpressionSelect(Range range, std::shared_ptr<IExpression> condition, std::vector<Case>&& cases) :
+		ExpressionSelect(SourceRange range, std::shared_ptr<IExpression> condition, std::vector<Case>&& cases) :
 			IExpression(std::move(range)),
 			m_condition(std::move(condition)),
 			m_cases(std::move(cases)) {}
@@ -450,7 +455,7 @@ namespace funcc::nar {
 		std::vector<std::shared_ptr<IExpression>> m_expressions;
 
 	public:
-		ExpressionTuple(Range range, std::vector<std::shared_ptr<IExpression>>&& expressions) :
+		ExpressionTuple(SourceRange range, std::vector<std::shared_ptr<IExpression>>&& expressions) :
 			IExpression(std::move(range)),
 			m_expressions(std::move(expressions)) {}
 
@@ -464,9 +469,9 @@ namespace funcc::nar {
 	class ExpressionUpdate final : public IExpression {
 	public:
 		struct Field {
-			Range range;
+			SourceRange range;
 			Identifier name;
-			Range nameRange;
+			SourceRange nameRange;
 			std::shared_ptr<IExpression> value;
 		};
 
@@ -475,7 +480,7 @@ namespace funcc::nar {
 		std::vector<Field> m_fields;
 
 	public:
-		ExpressionUpdate(Range range, std::shared_ptr<IExpression> record, std::vector<Field>&& fields) :
+		ExpressionUpdate(SourceRange range, std::shared_ptr<IExpression> record, std::vector<Field>&& fields) :
 			IExpression(std::move(range)),
 			m_record(std::move(record)),
 			m_fields(std::move(fields)) {}
@@ -495,7 +500,7 @@ namespace funcc::nar {
 		QualifiedIdentifier m_name;
 
 	public:
-		ExpressionVar(Range range, QualifiedIdentifier name) :
+		ExpressionVar(SourceRange range, QualifiedIdentifier name) :
 			IExpression(std::move(range)),
 			m_name(std::move(name)) {}
 
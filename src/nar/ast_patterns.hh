@@ -9,7 +9,12 @@ namespace funcc::nar {
 		std::shared_ptr<IPattern> m_nested;
 
 	public:
-		PatternAlias(Range range, std::shared_ptr<IType> type, Identifier name, std::shared_ptr<IPattern> nested) :
+		PatternAlias(
+			SourceRange range,
+			std::shared_ptr<IType> type,
+			Identifier name,
+			std::shared_ptr<IPattern> nested
+		) :
 			IPattern(range, std::move(type)),
 			m_name(std::move(name)),
 			m_nested(std::move(nested)) {}
@@ -27,7 +32,7 @@ namespace funcc::nar {
 
 	class PatternAny final : public IPattern {
 	public:
-		PatternAny(Range range, std::shared_ptr<IType> type) :
+		PatternAny(SourceRange range, std::shared_ptr<IType> type) :
 			IPattern(range, std::move(type)) {}
 
 		~PatternAny() override = default;
@@ -43,7 +48,7 @@ namespace funcc::nar {
 
 	public:
 		PatternCons(
-			Range range,
+			SourceRange range,
 			std::shared_ptr<IType> type,
 			std::shared_ptr<IPattern> head,
 			std::shared_ptr<IPattern> tail
@@ -67,7 +72,7 @@ namespace funcc::nar {
 		std::shared_ptr<IConst> m_value;
 
 	public:
-		PatternConst(Range range, std::shared_ptr<IType> type, std::shared_ptr<IConst> value) :
+		PatternConst(SourceRange range, std::shared_ptr<IType> type, std::shared_ptr<IConst> value) :
 			IPattern(range, std::move(type)),
 			m_value(std::move(value)) {}
 
@@ -82,7 +87,7 @@ namespace funcc::nar {
 		Identifier m_name;
 
 	public:
-		PatternNamed(Range range, std::shared_ptr<IType> type, Identifier name) :
+		PatternNamed(SourceRange range, std::shared_ptr<IType> type, Identifier name) :
 			IPattern(range, std::move(type)),
 			m_name(std::move(name)) {}
 
@@ -95,15 +100,15 @@ namespace funcc::nar {
 
 	class PatternDataConstructor final : public IPattern {
 		Identifier m_name;
-		Range m_nameRange;
+		SourceRange m_nameRange;
 		std::vector<std::shared_ptr<IPattern>> m_values;
 
 	public:
 		PatternDataConstructor(
-			Range range,
+			SourceRange range,
 			std::shared_ptr<IType> type,
 			Identifier name,
-			Range nameRange,
+			SourceRange nameRange,
 			std::vector<std::shared_ptr<IPattern>>&& values
 		) :
 			IPattern(range, std::move(type)),
@@ -117,7 +122,7 @@ namespace funcc::nar {
 			return m_name;
 		}
 
-		[[nodiscard]] Range const& GetNameRange() const {
+		[[nodiscard]] SourceRange const& GetNameRange() const {
 			return m_nameRange;
 		}
 
@@ -130,7 +135,7 @@ namespace funcc::nar {
 		std::vector<std::shared_ptr<IPattern>> m_patterns;
 
 	public:
-		PatternList(Range range, std::shared_ptr<IType> type, std::vector<std::shared_ptr<IPattern>>&& patterns) :
+		PatternList(SourceRange range, std::shared_ptr<IType> type, std::vector<std::shared_ptr<IPattern>>&& patterns) :
 			IPattern(range, std::move(type)),
 			m_patterns(std::move(patterns)) {}
 
@@ -142,16 +147,20 @@ namespace funcc::nar {
 	};
 
 	class PatternRecord final : public IPattern {
-		std::vector<std::pair<Range, Identifier>> m_fields;
+		std::vector<std::pair<SourceRange, Identifier>> m_fields;
 
 	public:
-		PatternRecord(Range range, std::shared_ptr<IType> type, std::vector<std::pair<Range, Identifier>>&& fields) :
+		PatternRecord(
+			SourceRange range,
+			std::shared_ptr<IType> type,
+			std::vector<std::pair<SourceRange, Identifier>>&& fields
+		) :
 			IPattern(range, std::move(type)),
 			m_fields(std::move(fields)) {}
 
 		~PatternRecord() override = default;
 
-		[[nodiscard]] std::vector<std::pair<Range, Identifier>> const& GetFields() const {
+		[[nodiscard]] std::vector<std::pair<SourceRange, Identifier>> const& GetFields() const {
 			return m_fields;
 		}
 	};
@@ -160,7 +169,7 @@ namespace funcc::nar {
 		std::vector<std::shared_ptr<IPattern>> m_items;
 
 	public:
-		PatternTuple(Range range, std::shared_ptr<IType> type, std::vector<std::shared_ptr<IPattern>>&& items) :
+		PatternTuple(SourceRange range, std::shared_ptr<IType> type, std::vector<std::shared_ptr<IPattern>>&& items) :
 			IPattern(range, std::move(type)),
 			m_items(std::move(items)) {}
 
@@ -6,15 +6,15 @@
 namespace funcc::nar {
 	class DataType final : public IDeclaration {
 		FullIdentifier m_name;
-		Range m_nameRange;
+		SourceRange m_nameRange;
 		std::vector<IType> m_args;
 		std::vector<DataConstructor> m_constructors;
 
 	public:
 		DataType(
-			Range range,
+			SourceRange range,
 			FullIdentifier name,
-			Range nameRange,
+			SourceRange nameRange,
 			std::vector<IType>&& args,
 			std::vector<DataConstructor>&& constructors
 		) :
@@ -30,7 +30,7 @@ namespace funcc::nar {
 			return m_name;
 		}
 
-		[[nodiscard]] Range const& GetNameRange() const {
+		[[nodiscard]] SourceRange const& GetNameRange() const {
 			return m_nameRange;
 		}
 
@@ -48,7 +48,11 @@ namespace funcc::nar {
 		std::shared_ptr<IType> m_returnType;
 
 	public:
-		FunctionType(Range range, std::vector<std::shared_ptr<IType>>&& params, std::shared_ptr<IType> returnType) :
+		FunctionType(
+			SourceRange range,
+			std::vector<std::shared_ptr<IType>>&& params,
+			std::shared_ptr<IType> returnType
+		) :
 			IType{std::move(range)},
 			m_params{std::move(params)},
 			m_returnType{std::move(returnType)} {}
@@ -66,11 +70,16 @@ namespace funcc::nar {
 
 	class NamedType final : public IType {
 		Identifier m_name;
-		Range m_nameRange;
+		SourceRange m_nameRange;
 		std::vector<std::shared_ptr<IType>> m_args;
 
 	public:
-		NamedType(Range range, Identifier name, Range nameRange, std::vector<std::shared_ptr<IType>>&& args) :
+		NamedType(
+			SourceRange range,
+			Identifier name,
+			SourceRange nameRange,
+			std::vector<std::shared_ptr<IType>>&& args
+		) :
 			IType{std::move(range)},
 			m_name{std::move(name)},
 			m_nameRange{std::move(nameRange)},
@@ -82,7 +91,7 @@ namespace funcc::nar {
 			return m_name;
 		}
 
-		[[nodiscard]] Range const& GetNameRange() const {
+		[[nodiscard]] SourceRange const& GetNameRange() const {
 			return m_nameRange;
 		}
 
@@ -93,11 +102,16 @@ namespace funcc::nar {
 
 	class NativeType final : public IType {
 		std::string m_name;
-		Range m_nameRange;
+		SourceRange m_nameRange;
 		std::vector<std::shared_ptr<IType>> m_args;
 
 	public:
-		NativeType(Range range, std::string name, Range nameRange, std::vector<std::shared_ptr<IType>>&& args) :
+		NativeType(
+			SourceRange range,
+			std::string name,
+			SourceRange nameRange,
+			std::vector<std::shared_ptr<IType>>&& args
+		) :
 			IType{std::move(range)},
 			m_name{std::move(name)},
 			m_nameRange{std::move(nameRange)},
@@ -109,7 +123,7 @@ namespace funcc::nar {
 			return m_name;
 		}
 
-		[[nodiscard]] Range const& GetNameRange() const {
+		[[nodiscard]] SourceRange const& GetNameRange() const {
 			return m_nameRange;
 		}
 
@@ -122,7 +136,7 @@ namespace funcc::nar {
 		Identifier m_name;
 
 	public:
-		VarintType(Range range, Identifier name) :
+		VarintType(SourceRange range, Identifier name) :
 			IType{std::move(range)},
 			m_name{std::move(name)} {}
 
@@ -135,7 +149,7 @@ namespace funcc::nar {
 
 	struct RecordField {
 		Identifier name;
-		Range nameRange;
+		SourceRange nameRange;
 		std::shared_ptr<IType> type;
 	};
 
@@ -143,7 +157,7 @@ namespace funcc::nar {
 		std::vector<RecordField> m_fields;
 
 	public:
-		RecordType(Range range, std::vector<RecordField>&& fields) :
+		RecordType(SourceRange range, std::vector<RecordField>&& fields) :
 			IType{std::move(range)},
 			m_fields{std::move(fields)} {}
 
@@ -158,7 +172,7 @@ namespace funcc::nar {
 		std::vector<std::shared_ptr<IType>> m_types;
 
 	public:
-		TupleType(Range range, std::vector<std::shared_ptr<IType>>&& types) :
+		TupleType(SourceRange range, std::vector<std::shared_ptr<IType>>&& types) :
 			IType{std::move(range)},
 			m_types{std::move(types)} {}
 
@@ -171,7 +185,7 @@ namespace funcc::nar {
 
 	class UnitType final : public IType {
 	public:
-		UnitType(Range range) :
+		UnitType(SourceRange range) :
 			IType{std::move(range)} {}
 
 		~UnitType() override = default;
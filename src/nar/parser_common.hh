@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../_external.hh"
+#include "../lexer.hh"
 #include "../parser.hh"
 #include "ast_common.hh"
 
@@ -10,7 +11,6 @@ namespace funcc::nar {
 	class CommonParser {
 	public:
 		using Tokens = std::vector<std::shared_ptr<IToken>>;
-		using Values = std::vector<std::shared_ptr<ITokenValue>>;
 		using IdentifierValue = funcc::parser::Value<nar::Identifier>;
 		using QualifiedIdentifierValue = funcc::parser::Value<nar::QualifiedIdentifier>;
 		using InfixIdentifierValue = funcc::parser::Value<nar::InfixIdentifier>;
@@ -95,6 +95,13 @@ namespace funcc::nar {
 		constexpr static std::string_view SmbIdentifierNotFirst = "0123456789_`";
 		constexpr static std::string_view SmbInfixIdentifier = "!#$%&*+-/:;<=>?^|~`";
 
+		// character classes of the identifier and operator scanners
+		inline static std::bitset<256> const ClsIdentifier = Scan::Class(SmbIdentifier);
+		inline static std::bitset<256> const ClsIdentifierFirst = ClsIdentifier & ~Scan::Class(SmbIdentifierNotFirst);
+		inline static std::bitset<256> const ClsQualifiedIdentifier =
+			ClsIdentifier | Scan::Class(std::string_view{&SmbIdentifierSeparator, 1});
+		inline static std::bitset<256> const ClsInfixIdentifier = Scan::Class(SmbInfixIdentifier);
+
 		inline static std::shared_ptr<IToken> PWS = IgnoreAny(
 			Tokens{
 				WhiteSpace(),
@@ -104,131 +111,125 @@ namespace funcc::nar {
 			nullptr
 		);
 
-		inline static std::shared_ptr<IToken> PQualifiedIdentifier = Map(
-			Entity(
-				[](std::string_view const& acc, uint32_t next, bool& outIsValid, bool& outIsComplete) {
-					outIsComplete = next != SmbIdentifierSeparator &&
-						SmbIdentifier.find(next) == std::string_view::npos;
-
-					if (outIsComplete) {
-						outIsValid = !acc.empty();
-
-						for (size_t i = 0; i < acc.length() && outIsValid; ++i) {
-							if (i == 0 || acc[i] == SmbIdentifierSeparator) {
-								outIsValid |= (i < acc.length() - 1) || (acc[i + 1] != SmbIdentifierSeparator) ||
-									(SmbIdentifierNotFirst.find(acc[i + 1]) == std::string_view::npos);
-							}
-						}
-					}
-				},
-				PWS
-			),
-			[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				std::string_view acc = std::dynamic_pointer_cast<SimpleValue>(value)->GetValue();
-				return std::make_shared<QualifiedIdentifierValue>(value->GetRange(), acc);
-			}
-		);
+		// separators may lead, trail and repeat, the parts are not checked for being identifiers
+		inline static std::shared_ptr<IToken> LxQualifiedIdentifier =
+			Word(ClsQualifiedIdentifier, ClsQualifiedIdentifier, PWS);
 
-		inline static std::shared_ptr<IToken> PIdentifier = Map(
-			Entity(
-				[](std::string_view const& acc, uint32_t next, bool& outIsValid, bool& outIsComplete) {
-					outIsComplete = SmbIdentifier.find(next) == std::string_view::npos;
-
-					if (outIsComplete) {
-						outIsValid = !acc.empty() && (SmbIdentifierNotFirst.find(acc[0]) == std::string_view::npos);
-					}
-				},
-				PWS
-			),
-			[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				std::string_view acc = std::dynamic_pointer_cast<SimpleValue>(value)->GetValue();
-				return std::make_shared<IdentifierValue>(value->GetRange(), acc);
-			}
-		);
+		inline static std::shared_ptr<ITokenValue> MapQualifiedIdentifier(std::shared_ptr<ITokenValue> const& value) {
+			return std::make_shared<QualifiedIdentifierValue>(value->GetRange(), value->As<WordValue>().GetSymbol());
+		}
 
-		inline static std::shared_ptr<IToken> PInfixIdentifier = Map(
-			Entity(
-				[](std::string_view const& acc, uint32_t next, bool& outIsValid, bool& outIsComplete) {
-					outIsComplete = SmbInfixIdentifier.find(next) == std::string_view::npos;
-
-					if (outIsComplete) {
-						outIsValid = !acc.empty();
-					}
-				},
-				PWS
-			),
-			[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				std::string_view acc = std::dynamic_pointer_cast<SimpleValue>(value)->GetValue();
-				return std::make_shared<InfixIdentifierValue>(value->GetRange(), acc);
-			}
-		);
+		inline static std::shared_ptr<IToken> PQualifiedIdentifier = Map(LxQualifiedIdentifier, MapQualifiedIdentifier);
+
+		inline static std::shared_ptr<IToken> LxIdentifier = Word(ClsIdentifierFirst, ClsIdentifier, PWS);
+
+		inline static std::shared_ptr<ITokenValue> MapIdentifier(std::shared_ptr<ITokenValue> const& value) {
+			return std::make_shared<IdentifierValue>(value->GetRange(), value->As<WordValue>().GetSymbol());
+		}
+
+		inline static std::shared_ptr<IToken> PIdentifier = Map(LxIdentifier, MapIdentifier);
+
+		inline static std::shared_ptr<IToken> LxInfixIdentifier =
+			Word(ClsInfixIdentifier, ClsInfixIdentifier, PWS);
+
+		inline static std::shared_ptr<ITokenValue> MapInfixIdentifier(std::shared_ptr<ITokenValue> const& value) {
+			return std::make_shared<InfixIdentifierValue>(value->GetRange(), value->As<WordValue>().GetSymbol());
+		}
+
+		inline static std::shared_ptr<IToken> PInfixIdentifier = Map(LxInfixIdentifier, MapInfixIdentifier);
+
+		inline static std::shared_ptr<ITokenValue> MapWrappedInfixIdentifier(
+			std::shared_ptr<ITokenValue> const& value
+		) {
+			MultiValue const& mv = value->As<MultiValue>();
+			return std::make_shared<InfixIdentifierValue>(
+				value->GetRange(),
+				mv[1].As<InfixIdentifierValue>().GetValue()
+			);
+		}
 
 		inline static std::shared_ptr<IToken> PWrappedInfixIdentifier = Map(
 			All(Tokens{Exact(SeqInfixOpen, PWS), PInfixIdentifier, Exact(SeqInfixClose, PWS)}, PWS),
-			[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				Values mv = std::dynamic_pointer_cast<MultiValue>(value)->GetValues();
-				return std::make_shared<InfixIdentifierValue>(
-					value->GetRange(),
-					std::dynamic_pointer_cast<InfixIdentifierValue>(mv[1])->GetValue()
-				);
-			}
+			MapWrappedInfixIdentifier
 		);
 
-		inline static std::shared_ptr<IToken> PConstChar = Map(
-			StringLiteral(SeqCharPrefix, SeqCharSuffix, SeqCharEscape, PWS),
-			[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				std::string_view acc = std::dynamic_pointer_cast<SimpleValue>(value)->GetValue();
-				acc =
-					acc.substr(SeqCharPrefix.length(), acc.length() - SeqCharPrefix.length() - SeqCharSuffix.length());
-				if (acc.length() == 1) {
-					return std::make_shared<ErrorValue>(value->GetRange(), "Expected single character");
-				}
-				return std::make_shared<ConstValue>(value->GetRange(), std::make_shared<ConstChar>(acc[0]));
+		// keywords starting a declaration, in the order of the declaration parsers
+		inline static std::shared_ptr<IToken> PKwDeclaration = Literals({KwAlias, KwInfix, KwData, KwDef}, PWS);
+
+		// keywords of an infix associativity, KwAssociativities holds what each of them stands for
+		inline static std::shared_ptr<IToken> PKwAssociativity = Literals({KwLeft, KwRight, KwNon}, PWS);
+		constexpr static std::array<Associativity, 3> KwAssociativities{
+			Associativity::Left,
+			Associativity::Right,
+			Associativity::None
+		};
+
+		inline static std::shared_ptr<IToken> LxChar = StringLiteral(SeqCharPrefix, SeqCharSuffix, SeqCharEscape, PWS);
+
+		inline static std::shared_ptr<IToken> LxString =
+			StringLiteral(SeqStringPrefix, SeqStringSuffix, SeqStringEscape, PWS);
+
+		inline static std::shared_ptr<IToken> LxNumber = NumberLiteral(PWS);
+
+		inline static std::shared_ptr<ITokenValue> MapConstChar(std::shared_ptr<ITokenValue> const& value) {
+			std::string_view acc = value->As<SimpleValue>().GetValue();
+			acc =
+				acc.substr(SeqCharPrefix.length(), acc.length() - SeqCharPrefix.length() - SeqCharSuffix.length());
+			if (acc.length() == 1) {
+				return std::make_shared<ErrorValue>(value->GetRange(), "Expected single character");
 			}
-		);
+			return std::make_shared<ConstValue>(value->GetRange(), std::make_shared<ConstChar>(acc[0]));
+		}
 
-		inline static std::shared_ptr<IToken> PConstInt =
-			Map(NumberLiteral(PWS), [](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				std::shared_ptr<NumberLiteralValue> number = std::dynamic_pointer_cast<NumberLiteralValue>(value);
-				if (!number->IsInteger()) {
-					return std::make_shared<ErrorValue>(value->GetRange(), "Expected integer");
-				}
-				return std::make_shared<ConstValue>(
-					value->GetRange(),
-					std::make_shared<ConstInt>(number->GetInteger())
-				);
-			});
-
-		inline static std::shared_ptr<IToken> PConstFloat =
-			Map(NumberLiteral(PWS), [](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				std::shared_ptr<NumberLiteralValue> number = std::dynamic_pointer_cast<NumberLiteralValue>(value);
-				if (!number->IsFloat()) {
-					return std::make_shared<ErrorValue>(value->GetRange(), "Expected float");
-				}
+		inline static std::shared_ptr<IToken> PConstChar = Map(LxChar, MapConstChar);
+
+		// the literal is classified by the lexer, so integers and floats come from one scan
+		static_assert(sizeof(TInt) >= sizeof(int64_t), "integer literals take the whole int64_t range");
+
+		inline static std::shared_ptr<ITokenValue> MapConstNumber(std::shared_ptr<ITokenValue> const& value) {
+			NumberLiteralValue const& number = value->As<NumberLiteralValue>();
+			if (number.IsInteger()) {
 				return std::make_shared<ConstValue>(
 					value->GetRange(),
-					std::make_shared<ConstFloat>(number->GetFloat())
-				);
-			});
-
-		inline static std::shared_ptr<IToken> PConstString = Map(
-			StringLiteral(SeqStringPrefix, SeqStringSuffix, SeqStringEscape, PWS),
-			[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				std::string_view acc = std::dynamic_pointer_cast<SimpleValue>(value)->GetValue();
-				acc = acc.substr(
-					SeqStringPrefix.length(),
-					acc.length() - SeqStringPrefix.length() - SeqStringSuffix.length()
+					std::make_shared<ConstInt>(number.GetInteger())
 				);
-				return std::make_shared<ConstValue>(value->GetRange(), std::make_shared<ConstString>(TString{acc}));
 			}
-		);
+			return std::make_shared<ConstValue>(value->GetRange(), std::make_shared<ConstFloat>(number.GetFloat()));
+		}
+
+		inline static std::shared_ptr<IToken> PConstNumber = Map(LxNumber, MapConstNumber);
 
-		inline static std::shared_ptr<IToken> PConstUnit =
-			Map(Exact(SeqUnitType, PWS), [](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				return std::make_shared<ConstValue>(value->GetRange(), std::make_shared<ConstUnit>());
-			});
+		inline static std::shared_ptr<ITokenValue> MapConstString(std::shared_ptr<ITokenValue> const& value) {
+			std::string_view acc = value->As<SimpleValue>().GetValue();
+			acc = acc.substr(
+				SeqStringPrefix.length(),
+				acc.length() - SeqStringPrefix.length() - SeqStringSuffix.length()
+			);
+			return std::make_shared<ConstValue>(value->GetRange(), std::make_shared<ConstString>(TString{acc}));
+		}
+
+		inline static std::shared_ptr<IToken> PConstString = Map(LxString, MapConstString);
+
+		inline static std::shared_ptr<ITokenValue> MapConstUnit(std::shared_ptr<ITokenValue> const& value) {
+			return std::make_shared<ConstValue>(value->GetRange(), std::make_shared<ConstUnit>());
+		}
+
+		inline static std::shared_ptr<IToken> PConstUnit = Map(Exact(SeqUnitType, PWS), MapConstUnit);
 
 		inline static std::shared_ptr<IToken> PConst =
-			OneOf(Tokens{PConstChar, PConstFloat, PConstInt, PConstString, PConstUnit}, PWS);
+			OneOf(Tokens{PConstChar, PConstNumber, PConstString, PConstUnit}, PWS);
+
+		// tokens the parser finds on lexeme boundaries, scanned once per file
+		inline static Lexer Lexicon{
+			PWS,
+			{
+				{LxString, false},
+				{LxChar, false},
+				{LxNumber, false},
+				{LxQualifiedIdentifier, true},
+				{LxIdentifier, true},
+				{LxInfixIdentifier, true},
+			}
+		};
 	};
 }
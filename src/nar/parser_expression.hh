@@ -20,36 +20,52 @@ namespace funcc::nar {
 		inline static std::shared_ptr<IToken> PExpression = ForwardDeclaration();
 		inline static std::shared_ptr<IToken> PLet = ForwardDeclaration();
 
+		inline static std::shared_ptr<ITokenValue> MapAccessor(std::shared_ptr<ITokenValue> const& value) {
+			MultiValue const& mv = value->As<MultiValue>();
+			return std::make_shared<ExpressionValue>(
+				value->GetRange(),
+				std::make_shared<ExpressionAccessor>(
+					value->GetRange(),
+					mv[1].As<C::IdentifierValue>().GetValue()
+				)
+			);
+		}
+
 		inline static std::shared_ptr<IToken> PAccessor = Map(
 			All(C::Tokens{Exact(C::SeqAccessor, C::PWS), C::PIdentifier}, C::PWS),
-			[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				return std::make_shared<ExpressionValue>(
-					value->GetRange(),
-					std::make_shared<ExpressionAccessor>(
-						value->GetRange(),
-						std::dynamic_pointer_cast<C::IdentifierValue>(value)->GetValue()
-					)
-				);
-			}
+			MapAccessor
 		);
 
-		inline static std::shared_ptr<IToken> PAccess = Map(
-			All(C::Tokens{PExpression, Repeat(Exact(C::SeqAccessor, C::PWS), PAccessor, C::PWS), C::PIdentifier}, C::PWS
-			),
-			[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				C::Values mv = std::dynamic_pointer_cast<MultiValue>(value)->GetValues();
-				return std::make_shared<ExpressionValue>(
+		inline static std::shared_ptr<ITokenValue> MapAccess(std::shared_ptr<ITokenValue> const& value) {
+			MultiValue const& mv = value->As<MultiValue>();
+			return std::make_shared<ExpressionValue>(
+				value->GetRange(),
+				std::make_shared<ExpressionAccess>(
 					value->GetRange(),
-					std::make_shared<ExpressionAccess>(
-						value->GetRange(),
-						std::dynamic_pointer_cast<ExpressionValue>(mv[0])->GetValue(),
-						std::dynamic_pointer_cast<C::IdentifierValue>(mv[2])->GetValue(),
-						mv[2]->GetRange()
-					)
-				);
-			}
+					mv[0].As<ExpressionValue>().GetValue(),
+					mv[2].As<C::IdentifierValue>().GetValue(),
+					mv[2].GetRange()
+				)
+			);
+		}
+
+		inline static std::shared_ptr<IToken> PAccess = Map(
+			All(C::Tokens{PExpression, Exact(C::SeqAccessor, C::PWS), C::PIdentifier}, C::PWS),
+			MapAccess
 		);
 
+		inline static std::shared_ptr<ITokenValue> MapApply(std::shared_ptr<ITokenValue> const& value) {
+			MultiValue const& mv = value->As<MultiValue>();
+			return std::make_shared<ExpressionValue>(
+				value->GetRange(),
+				std::make_shared<ExpressionApply>(
+					value->GetRange(),
+					mv[0].As<ExpressionValue>().GetValue(),
+					mv[1].As<MultiValue>().Extract<std::shared_ptr<IExpression>>()
+				)
+			);
+		}
+
 		inline static std::shared_ptr<IToken> PApply = Map(
 			All(
 				C::Tokens{
@@ -64,19 +80,25 @@ namespace funcc::nar {
 				},
 				C::PWS
 			),
-			[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				C::Values mv = std::dynamic_pointer_cast<MultiValue>(value)->GetValues();
-				return std::make_shared<ExpressionValue>(
-					value->GetRange(),
-					std::make_shared<ExpressionApply>(
-						value->GetRange(),
-						std::dynamic_pointer_cast<ExpressionValue>(mv[0])->GetValue(),
-						std::dynamic_pointer_cast<MultiValue>(mv[1])->Extract<std::shared_ptr<IExpression>>()
-					)
-				);
-			}
+			MapApply
 		);
 
+		inline static std::shared_ptr<ITokenValue> MapBinOp(std::shared_ptr<ITokenValue> const& value) {
+			MultiValue const& mv = value->As<MultiValue>();
+			return std::make_shared<ExpressionValue>(
+				value->GetRange(),
+				std::make_shared<ExpressionBinOp>(
+					value->GetRange(),
+					mv[0].As<ExpressionValue>().GetValue(),
+					std::make_shared<ExpressionInfixVar>(
+						mv[1].GetRange(),
+						mv[1].As<C::InfixIdentifierValue>().GetValue()
+					),
+					mv[2].As<ExpressionValue>().GetValue()
+				)
+			);
+		}
+
 		inline static std::shared_ptr<IToken> PBinOp = Map(
 			All(
 				C::Tokens{
@@ -87,33 +109,33 @@ namespace funcc::nar {
 				},
 				C::PWS
 			),
-			[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				C::Values mv = std::dynamic_pointer_cast<MultiValue>(value)->GetValues();
-				return std::make_shared<ExpressionValue>(
-					value->GetRange(),
-					std::make_shared<ExpressionBinOp>(
-						value->GetRange(),
-						std::dynamic_pointer_cast<ExpressionValue>(mv[0])->GetValue(),
-						std::make_shared<ExpressionInfixVar>(
-							mv[1]->GetRange(),
-							std::dynamic_pointer_cast<C::InfixIdentifierValue>(mv[1])->GetValue()
-						),
-						std::dynamic_pointer_cast<ExpressionValue>(mv[2])->GetValue()
-					)
-				);
-			}
+			MapBinOp
 		);
 
-		inline static std::shared_ptr<IToken> PConst =
-			Map(C::PConst, [](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				return std::make_shared<ExpressionValue>(
+		inline static std::shared_ptr<ITokenValue> MapConst(std::shared_ptr<ITokenValue> const& value) {
+			return std::make_shared<ExpressionValue>(
+				value->GetRange(),
+				std::make_shared<ExpressionConst>(
 					value->GetRange(),
-					std::make_shared<ExpressionConst>(
-						value->GetRange(),
-						std::dynamic_pointer_cast<C::ConstValue>(value)->GetValue()
-					)
-				);
-			});
+					value->As<C::ConstValue>().GetValue()
+				)
+			);
+		}
+
+		inline static std::shared_ptr<IToken> PConst = Map(C::PConst, MapConst);
+
+		inline static std::shared_ptr<ITokenValue> MapIf(std::shared_ptr<ITokenValue> const& value) {
+			MultiValue const& mv = value->As<MultiValue>();
+			return std::make_shared<ExpressionValue>(
+				value->GetRange(),
+				std::make_shared<ExpressionIf>(
+					value->GetRange(),
+					mv[1].As<ExpressionValue>().GetValue(),
+					mv[3].As<ExpressionValue>().GetValue(),
+					mv[5].As<ExpressionValue>().GetValue()
+				)
+			);
+		}
 
 		inline static std::shared_ptr<IToken> PIf = Map(
 			All(
@@ -127,32 +149,33 @@ namespace funcc::nar {
 				},
 				C::PWS
 			),
-			[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				C::Values mv = std::dynamic_pointer_cast<MultiValue>(value)->GetValues();
-				return std::make_shared<ExpressionValue>(
-					value->GetRange(),
-					std::make_shared<ExpressionIf>(
-						value->GetRange(),
-						std::dynamic_pointer_cast<ExpressionValue>(mv[1])->GetValue(),
-						std::dynamic_pointer_cast<ExpressionValue>(mv[3])->GetValue(),
-						std::dynamic_pointer_cast<ExpressionValue>(mv[5])->GetValue()
-					)
-				);
-			}
+			MapIf
 		);
 
-		inline static std::shared_ptr<IToken> PInfix = Map(
-			C::PWrappedInfixIdentifier,
-			[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				return std::make_shared<ExpressionValue>(
+		inline static std::shared_ptr<ITokenValue> MapInfix(std::shared_ptr<ITokenValue> const& value) {
+			return std::make_shared<ExpressionValue>(
+				value->GetRange(),
+				std::make_shared<ExpressionInfixVar>(
 					value->GetRange(),
-					std::make_shared<ExpressionInfixVar>(
-						value->GetRange(),
-						std::dynamic_pointer_cast<C::InfixIdentifierValue>(value)->GetValue()
-					)
-				);
-			}
-		);
+					value->As<C::InfixIdentifierValue>().GetValue()
+				)
+			);
+		}
+
+		inline static std::shared_ptr<IToken> PInfix = Map(C::PWrappedInfixIdentifier, MapInfix);
+
+		inline static std::shared_ptr<ITokenValue> MapLambda(std::shared_ptr<ITokenValue> const& value) {
+			MultiValue const& mv = value->As<MultiValue>();
+			return std::make_shared<ExpressionValue>(
+				value->GetRange(),
+				std::make_shared<ExpressionLambda>(
+					value->GetRange(),
+					mv[1].As<MultiValue>().Extract<std::shared_ptr<IPattern>>(),
+					mv[2].IsSkipped() ? nullptr : mv[2].As<T::TypeValue>().GetValue(),
+					mv[4].As<ExpressionValue>().GetValue()
+				)
+			);
+		}
 
 		inline static std::shared_ptr<IToken> PLambda = Map(
 			All(
@@ -165,20 +188,31 @@ namespace funcc::nar {
 				},
 				C::PWS
 			),
-			[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				C::Values mv = std::dynamic_pointer_cast<MultiValue>(value)->GetValues();
-				return std::make_shared<ExpressionValue>(
-					value->GetRange(),
-					std::make_shared<ExpressionLambda>(
-						value->GetRange(),
-						std::dynamic_pointer_cast<MultiValue>(mv[1])->Extract<std::shared_ptr<IPattern>>(),
-						mv[2]->IsSkipped() ? nullptr : std::dynamic_pointer_cast<T::TypeValue>(mv[2])->GetValue(),
-						std::dynamic_pointer_cast<ExpressionValue>(mv[4])->GetValue()
-					)
-				);
-			}
+			MapLambda
 		);
 
+		inline static std::shared_ptr<ITokenValue> MapLetIn(std::shared_ptr<ITokenValue> const& value) {
+			return value->As<MultiValue>().GetValues()[1];
+		}
+
+		inline static std::shared_ptr<ITokenValue> MapLetFunction(std::shared_ptr<ITokenValue> const& value) {
+			MultiValue const& mv = value->As<MultiValue>();
+			P::FunctionSignature signature = mv[1].As<P::FunctionSignatureValue>().GetValue(
+			);
+			return std::make_shared<ExpressionValue>(
+				value->GetRange(),
+				std::make_shared<ExpressionLetFunction>(
+					value->GetRange(),
+					signature.name,
+					signature.nameRange,
+					std::move(signature.params),
+					signature.returnType,
+					mv[3].As<ExpressionValue>().GetValue(),
+					mv[4].As<ExpressionValue>().GetValue()
+				)
+			);
+		}
+
 		inline static std::shared_ptr<IToken> PLetFunction = Map(
 			All(
 				C::Tokens{
@@ -188,10 +222,7 @@ namespace funcc::nar {
 					PExpression,
 					OneOf(
 						C::Tokens{
-							Map(All(C::Tokens{Exact(C::KwIn, C::PWS), PExpression}, C::PWS),
-								[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-									return std::dynamic_pointer_cast<MultiValue>(value)->GetValues()[1];
-								}),
+							Map(All(C::Tokens{Exact(C::KwIn, C::PWS), PExpression}, C::PWS), MapLetIn),
 							PLet,
 						},
 						C::PWS
@@ -199,25 +230,22 @@ namespace funcc::nar {
 				},
 				C::PWS
 			),
-			[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				C::Values mv = std::dynamic_pointer_cast<MultiValue>(value)->GetValues();
-				P::FunctionSignature signature = std::dynamic_pointer_cast<P::FunctionSignatureValue>(mv[1])->GetValue(
-				);
-				return std::make_shared<ExpressionValue>(
-					value->GetRange(),
-					std::make_shared<ExpressionLetFunction>(
-						value->GetRange(),
-						signature.name,
-						signature.nameRange,
-						std::move(signature.params),
-						signature.returnType,
-						std::dynamic_pointer_cast<ExpressionValue>(mv[3])->GetValue(),
-						std::dynamic_pointer_cast<ExpressionValue>(mv[4])->GetValue()
-					)
-				);
-			}
+			MapLetFunction
 		);
 
+		inline static std::shared_ptr<ITokenValue> MapLetValue(std::shared_ptr<ITokenValue> const& value) {
+			MultiValue const& mv = value->As<MultiValue>();
+			return std::make_shared<ExpressionValue>(
+				value->GetRange(),
+				std::make_shared<ExpressionLetVar>(
+					value->GetRange(),
+					mv[1].As<P::PatternValue>().GetValue(),
+					mv[3].As<ExpressionValue>().GetValue(),
+					mv[4].As<ExpressionValue>().GetValue()
+				)
+			);
+		}
+
 		inline static std::shared_ptr<IToken> PLetValue = Map(
 			All(
 				C::Tokens{
@@ -227,10 +255,7 @@ namespace funcc::nar {
 					PExpression,
 					OneOf(
 						C::Tokens{
-							Map(All(C::Tokens{Exact(C::KwIn, C::PWS), PExpression}, C::PWS),
-								[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-									return std::dynamic_pointer_cast<MultiValue>(value)->GetValues()[1];
-								}),
+							Map(All(C::Tokens{Exact(C::KwIn, C::PWS), PExpression}, C::PWS), MapLetIn),
 							PLet,
 						},
 						C::PWS
@@ -238,20 +263,19 @@ namespace funcc::nar {
 				},
 				C::PWS
 			),
-			[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				C::Values mv = std::dynamic_pointer_cast<MultiValue>(value)->GetValues();
-				return std::make_shared<ExpressionValue>(
-					value->GetRange(),
-					std::make_shared<ExpressionLetVar>(
-						value->GetRange(),
-						std::dynamic_pointer_cast<P::PatternValue>(mv[1])->GetValue(),
-						std::dynamic_pointer_cast<ExpressionValue>(mv[3])->GetValue(),
-						std::dynamic_pointer_cast<ExpressionValue>(mv[4])->GetValue()
-					)
-				);
-			}
+			MapLetValue
 		);
 
+		inline static std::shared_ptr<ITokenValue> MapList(std::shared_ptr<ITokenValue> const& value) {
+			return std::make_shared<ExpressionValue>(
+				value->GetRange(),
+				std::make_shared<ExpressionList>(
+					value->GetRange(),
+					value->As<MultiValue>().Extract<std::shared_ptr<IExpression>>()
+				)
+			);
+		}
+
 		inline static std::shared_ptr<IToken> PList = Map(
 			Debug(Some(
 				PExpression,
@@ -262,30 +286,43 @@ namespace funcc::nar {
 				nullptr,  // firstItem
 				true  // allowEmpty
 			)),
-			[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				C::Values mv = std::dynamic_pointer_cast<MultiValue>(value)->GetValues();
-				return std::make_shared<ExpressionValue>(
-					value->GetRange(),
-					std::make_shared<ExpressionList>(
-						value->GetRange(),
-						std::dynamic_pointer_cast<MultiValue>(mv[0])->Extract<std::shared_ptr<IExpression>>()
-					)
-				);
-			}
+			MapList
 		);
 
+		inline static std::shared_ptr<ITokenValue> MapNegate(std::shared_ptr<ITokenValue> const& value) {
+			return std::make_shared<ExpressionValue>(
+				value->GetRange(),
+				std::make_shared<ExpressionNegate>(
+					value->GetRange(),
+					value->As<MultiValue>()[1].As<ExpressionValue>().GetValue()
+				)
+			);
+		}
+
 		inline static std::shared_ptr<IToken> PNegate = Map(
 			All(C::Tokens{Exact(C::SeqNegate, C::PWS), PExpression}, C::PWS),
-			[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				return std::make_shared<ExpressionValue>(
+			MapNegate
+		);
+
+		inline static std::shared_ptr<ITokenValue> MapRecord(std::shared_ptr<ITokenValue> const& value) {
+			return std::make_shared<ExpressionValue>(
+				value->GetRange(),
+				std::make_shared<ExpressionRecord>(
 					value->GetRange(),
-					std::make_shared<ExpressionNegate>(
-						value->GetRange(),
-						std::dynamic_pointer_cast<ExpressionValue>(value)->GetValue()
+					value->As<MultiValue>().Extract<ExpressionRecord::Field>(
+						[](ITokenValue const& fieldValue) -> ExpressionRecord::Field {
+							MultiValue const& mv = fieldValue.As<MultiValue>();
+							return ExpressionRecord::Field{
+								.range = fieldValue.GetRange(),
+								.name = mv[0].As<C::IdentifierValue>().GetValue(),
+								.nameRange = mv[0].GetRange(),
+								.value = mv[2].As<ExpressionValue>().GetValue()
+							};
+						}
 					)
-				);
-			}
-		);
+				)
+			);
+		}
 
 		inline static std::shared_ptr<IToken> PRecord = Map(
 			Some(
@@ -297,26 +334,29 @@ namespace funcc::nar {
 				nullptr,  // firstItem
 				true  // allowEmpty
 			),
-			[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				return std::make_shared<ExpressionValue>(
+			MapRecord
+		);
+
+		inline static std::shared_ptr<ITokenValue> MapSelect(std::shared_ptr<ITokenValue> const& value) {
+			MultiValue const& mv = value->As<MultiValue>();
+			return std::make_shared<ExpressionValue>(
+				value->GetRange(),
+				std::make_shared<ExpressionSelect>(
 					value->GetRange(),
-					std::make_shared<ExpressionRecord>(
-						value->GetRange(),
-						std::dynamic_pointer_cast<MultiValue>(value)->Extract<ExpressionRecord::Field>(
-							[](std::shared_ptr<ITokenValue> const& fieldValue) -> ExpressionRecord::Field {
-								C::Values mv = std::dynamic_pointer_cast<MultiValue>(fieldValue)->GetValues();
-								return ExpressionRecord::Field{
-									.range = fieldValue->GetRange(),
-									.name = std::dynamic_pointer_cast<C::IdentifierValue>(mv[0])->GetValue(),
-									.nameRange = mv[0]->GetRange(),
-									.value = std::dynamic_pointer_cast<ExpressionValue>(mv[2])->GetValue()
-								};
-							}
-						)
+					mv[1].As<ExpressionValue>().GetValue(),
+					mv[2].As<MultiValue>().Extract<ExpressionSelect::Case>(
+						[](ITokenValue const& caseValue) -> ExpressionSelect::Case {
+							MultiValue const& mv = caseValue.As<MultiValue>();
+							return ExpressionSelect::Case{
+								.range = caseValue.GetRange(),
+								.pattern = mv[1].As<P::PatternValue>().GetValue(),
+								.expression = mv[3].As<ExpressionValue>().GetValue()
+							};
+						}
 					)
-				);
-			}
-		);
+				)
+			);
+		}
 
 		inline static std::shared_ptr<IToken> PSelect = Map(
 			All(
@@ -333,28 +373,19 @@ namespace funcc::nar {
 				},
 				C::PWS
 			),
-			[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				C::Values mv = std::dynamic_pointer_cast<MultiValue>(value)->GetValues();
-				return std::make_shared<ExpressionValue>(
-					value->GetRange(),
-					std::make_shared<ExpressionSelect>(
-						value->GetRange(),
-						std::dynamic_pointer_cast<ExpressionValue>(mv[1])->GetValue(),
-						std::dynamic_pointer_cast<MultiValue>(mv[2])->Extract<ExpressionSelect::Case>(
-							[](std::shared_ptr<ITokenValue> const& caseValue) -> ExpressionSelect::Case {
-								C::Values mv = std::dynamic_pointer_cast<MultiValue>(caseValue)->GetValues();
-								return ExpressionSelect::Case{
-									.range = caseValue->GetRange(),
-									.pattern = std::dynamic_pointer_cast<P::PatternValue>(mv[1])->GetValue(),
-									.expression = std::dynamic_pointer_cast<ExpressionValue>(mv[3])->GetValue()
-								};
-							}
-						)
-					)
-				);
-			}
+			MapSelect
 		);
 
+		inline static std::shared_ptr<ITokenValue> MapTuple(std::shared_ptr<ITokenValue> const& value) {
+			return std::make_shared<ExpressionValue>(
+				value->GetRange(),
+				std::make_shared<ExpressionTuple>(
+					value->GetRange(),
+					value->As<MultiValue>().Extract<std::shared_ptr<IExpression>>()
+				)
+			);
+		}
+
 		inline static std::shared_ptr<IToken> PTuple = Map(
 			Some(
 				PExpression,
@@ -363,18 +394,31 @@ namespace funcc::nar {
 				Exact(C::SeqTupleSep, C::PWS),
 				C::PWS
 			),
-			[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				C::Values mv = std::dynamic_pointer_cast<MultiValue>(value)->GetValues();
-				return std::make_shared<ExpressionValue>(
-					value->GetRange(),
-					std::make_shared<ExpressionTuple>(
-						value->GetRange(),
-						std::dynamic_pointer_cast<MultiValue>(mv[0])->Extract<std::shared_ptr<IExpression>>()
-					)
-				);
-			}
+			MapTuple
 		);
 
+		inline static std::shared_ptr<ITokenValue> MapUpdate(std::shared_ptr<ITokenValue> const& value) {
+			MultiValue const& mv = value->As<MultiValue>();
+			return std::make_shared<ExpressionValue>(
+				value->GetRange(),
+				std::make_shared<ExpressionUpdate>(
+					mv[0].GetRange(),
+					mv[1].As<ExpressionValue>().GetValue(),
+					mv[3].As<MultiValue>().Extract<ExpressionUpdate::Field>(
+						[](ITokenValue const& fieldValue) -> ExpressionUpdate::Field {
+							MultiValue const& mv = fieldValue.As<MultiValue>();
+							return ExpressionUpdate::Field{
+								.range = fieldValue.GetRange(),
+								.name = mv[0].As<C::IdentifierValue>().GetValue(),
+								.nameRange = mv[0].GetRange(),
+								.value = mv[2].As<ExpressionValue>().GetValue()
+							};
+						}
+					)
+				)
+			);
+		}
+
 		inline static std::shared_ptr<IToken> PUpdate = Map(
 			All(
 				C::Tokens{
@@ -392,39 +436,20 @@ namespace funcc::nar {
 				},
 				C::PWS
 			),
-			[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				C::Values mv = std::dynamic_pointer_cast<MultiValue>(value)->GetValues();
-				return std::make_shared<ExpressionValue>(
-					value->GetRange(),
-					std::make_shared<ExpressionUpdate>(
-						mv[0]->GetRange(),
-						std::dynamic_pointer_cast<ExpressionValue>(mv[1])->GetValue(),
-						std::dynamic_pointer_cast<MultiValue>(mv[3])->Extract<ExpressionUpdate::Field>(
-							[](std::shared_ptr<ITokenValue> const& fieldValue) -> ExpressionUpdate::Field {
-								C::Values mv = std::dynamic_pointer_cast<MultiValue>(fieldValue)->GetValues();
-								return ExpressionUpdate::Field{
-									.range = fieldValue->GetRange(),
-									.name = std::dynamic_pointer_cast<C::IdentifierValue>(mv[0])->GetValue(),
-									.nameRange = mv[0]->GetRange(),
-									.value = std::dynamic_pointer_cast<ExpressionValue>(mv[2])->GetValue()
-								};
-							}
-						)
-					)
-				);
-			}
+			MapUpdate
 		);
 
-		inline static std::shared_ptr<IToken> PVar =
-			Map(C::PQualifiedIdentifier, [](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				return std::make_shared<ExpressionValue>(
+		inline static std::shared_ptr<ITokenValue> MapVar(std::shared_ptr<ITokenValue> const& value) {
+			return std::make_shared<ExpressionValue>(
+				value->GetRange(),
+				std::make_shared<ExpressionVar>(
 					value->GetRange(),
-					std::make_shared<ExpressionVar>(
-						value->GetRange(),
-						std::dynamic_pointer_cast<C::QualifiedIdentifierValue>(value)->GetValue()
-					)
-				);
-			});
+					value->As<C::QualifiedIdentifierValue>().GetValue()
+				)
+			);
+		}
+
+		inline static std::shared_ptr<IToken> PVar = Map(C::PQualifiedIdentifier, MapVar);
 
 	private:
 		inline static ForwardDeclarationToken::Replacement PExpressionReplacement{
@@ -446,9 +471,14 @@ namespace funcc::nar {
 				PTuple,
 				PUpdate,
 				PVar
-			}
+			},
+			C::PWS
 		};
 
-		inline static ForwardDeclarationToken::Replacement PLetReplacement{PLet, C::Tokens{PLetFunction, PLetValue}};
+		inline static ForwardDeclarationToken::Replacement PLetReplacement{
+			PLet,
+			C::Tokens{PLetFunction, PLetValue},
+			C::PWS
+		};
 	};
 }
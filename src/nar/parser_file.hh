@@ -23,10 +23,7 @@ namespace funcc::nar {
 
 	public:
 		using ImportValue = Value<nar::Import>;
-		using InfixValue = Value<nar::Infix>;
-		using AliasValue = Value<nar::Alias>;
-		using FunctionValue = Value<nar::Function>;
-		using DataValue = Value<nar::Data>;
+		using DeclarationValue = Value<std::shared_ptr<nar::IDeclaration>>;
 		using DataConstructorParameterValue = Value<nar::DataConstructorParameter>;
 		using DataConstructorParametersValue = Value<std::vector<nar::DataConstructorParameter>>;
 		using DataConstructorValue = Value<DataConstructor>;
@@ -47,11 +44,13 @@ namespace funcc::nar {
 		constexpr static std::string_view SeqCaseBind = "->";
 		constexpr static std::string_view SeqInfixChars = "!#$%&*+-/:;<=>?^|~`";*/
 
+		inline static std::shared_ptr<ITokenValue> MapModule(std::shared_ptr<ITokenValue> const& value) {
+			return value->As<MultiValue>().GetValues()[1];
+		}
+
 		inline static std::shared_ptr<IToken> PModule = Map(
 			All(C::Tokens{Exact(C::KwModule, C::PWS), C::PQualifiedIdentifier}, C::PWS),
-			[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				return std::dynamic_pointer_cast<MultiValue>(value)->GetValues()[1];
-			}
+			MapModule
 		);
 
 		inline static std::shared_ptr<IToken> PImportExposing = OneOf(
@@ -68,6 +67,30 @@ namespace funcc::nar {
 			C::PWS
 		);
 
+		inline static std::shared_ptr<ITokenValue> MapImport(std::shared_ptr<ITokenValue> const& value) {
+			MultiValue const& mv = value->As<MultiValue>();
+			Import import{
+				.range = value->GetRange(),
+				.module = mv[1].As<C::QualifiedIdentifierValue>().GetValue(),
+				.alias = Identifier{},
+				.exposeAll = false,
+				.expose = {},
+			};
+			if (mv[2].GetKind() != ValueKind::SkippedOptional) {
+				import.alias = mv[2].As<MultiValue>()[1].As<C::IdentifierValue>().GetValue();
+			}
+
+			if (mv[3].GetKind() != ValueKind::SkippedOptional) {
+				ITokenValue const& expose = mv[3].As<MultiValue>()[1];
+				if (expose.GetKind() == ValueKind::Exact) {
+					import.exposeAll = true;
+				} else {
+					import.expose = expose.As<MultiValue>().Extract<nar::Identifier>();
+				}
+			}
+			return std::make_shared<ImportValue>(value->GetRange(), std::move(import));
+		}
+
 		inline static std::shared_ptr<IToken> PImport = Map(
 			All(
 				C::Tokens{
@@ -78,26 +101,7 @@ namespace funcc::nar {
 				},
 				C::PWS
 			),
-			[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				C::Values const& mv = std::dynamic_pointer_cast<MultiValue>(value)->GetValues();
-				Import import{
-					.range = value->GetRange(),
-					.module = std::dynamic_pointer_cast<C::QualifiedIdentifierValue>(mv[1])->GetValue(),
-				};
-				if (mv[2]->GetKind() != ValueKind::SkippedOptional) {
-					import.alias = std::dynamic_pointer_cast<C::IdentifierValue>(mv[2])->GetValue();
-				}
-
-				if (mv[3]->GetKind() != ValueKind::SkippedOptional) {
-					std::shared_ptr<ITokenValue> expose = std::dynamic_pointer_cast<MultiValue>(mv[3])->GetValues()[1];
-					if (expose->GetKind() == ValueKind::Exact) {
-						import.exposeAll = true;
-					} else {
-						import.expose = std::dynamic_pointer_cast<MultiValue>(expose)->Extract<nar::Identifier>();
-					}
-				}
-				return std::make_shared<ImportValue>(value->GetRange(), std::move(import));
-			}
+			MapImport
 		);
 
 		inline static std::shared_ptr<IToken> PImports = Repeat(
@@ -108,6 +112,26 @@ namespace funcc::nar {
 			true
 		);
 
+		inline static std::shared_ptr<ITokenValue> MapAlias(std::shared_ptr<ITokenValue> const& value) {
+			MultiValue const& mv = value->As<MultiValue>();
+			bool hidden = !mv[1].IsSkipped();
+			MultiValue const& body = mv[2].As<MultiValue>();
+
+			return std::make_shared<DeclarationValue>(
+				value->GetRange(),
+				std::make_shared<nar::Alias>(
+					value->GetRange(),
+					body[0].As<C::IdentifierValue>().GetValue(),
+					body[0].GetRange(),
+					hidden,
+					body.GetSize() < 4 ? nullptr : body[3].As<T::TypeValue>().GetValue(),
+					body[1].IsSkipped()
+						? std::vector<std::shared_ptr<nar::IType>>{}
+						: body[1].As<MultiValue>().Extract<std::shared_ptr<nar::IType>>()
+				)
+			);
+		}
+
 		inline static std::shared_ptr<IToken> PAlias = Map(
 			All(
 				C::Tokens{
@@ -129,26 +153,33 @@ namespace funcc::nar {
 				},
 				C::PWS
 			),
-			[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				C::Values mv = std::dynamic_pointer_cast<MultiValue>(value)->GetValues();
-				bool hidden = !mv[1]->IsSkipped();
-				mv = std::dynamic_pointer_cast<MultiValue>(mv[2])->GetValues();
+			MapAlias
+		);
 
-				return std::make_shared<AliasValue>(
-					value->GetRange(),
-					nar::Alias{
-						value->GetRange(),
-						std::dynamic_pointer_cast<C::IdentifierValue>(mv[0])->GetValue(),
-						mv[0]->GetRange(),
-						hidden,
-						mv.size() < 4 ? nullptr : std::dynamic_pointer_cast<T::TypeValue>(mv[3])->GetValue(),
-						mv[1]->IsSkipped()
-							? std::vector<std::shared_ptr<nar::IType>>{}
-							: std::dynamic_pointer_cast<MultiValue>(mv[1])->Extract<std::shared_ptr<nar::IType>>(),
-					}
+		inline static std::shared_ptr<ITokenValue> MapInfix(std::shared_ptr<ITokenValue> const& value) {
+			MultiValue const& mv = value->As<MultiValue>();
+			NumberLiteralValue const& precedence = mv[6].As<NumberLiteralValue>();
+			if (!precedence.IsInteger()) {
+				return std::make_shared<ErrorValue>(
+					precedence.GetRange(),
+					"Expected integer for infix operator precedence"
 				);
 			}
-		);
+			Associativity assoc = C::KwAssociativities[mv[5].As<LiteralValue>().GetIndex()];
+
+			return std::make_shared<DeclarationValue>(
+				value->GetRange(),
+				std::make_shared<nar::Infix>(
+					value->GetRange(),
+					mv[2].As<C::InfixIdentifierValue>().GetValue(),
+					mv[2].GetRange(),
+					!mv[1].IsSkipped(),
+					assoc,
+					precedence.GetInteger(),
+					mv[9].As<C::IdentifierValue>().GetValue()
+				)
+			);
+		}
 
 		// TODO: proposal to think about changing the syntax of infix operator definition, eg `infix (++): left<5> = fn`
 		inline static std::shared_ptr<IToken> PInfix = Map(
@@ -159,10 +190,7 @@ namespace funcc::nar {
 					C::PWrappedInfixIdentifier,
 					Exact(C::SeqInfixTypeDecl, C::PWS),
 					Exact(C::SeqInfixTypeOpen, C::PWS),
-					OneOf(
-						C::Tokens{Exact(C::KwLeft, C::PWS), Exact(C::KwRight, C::PWS), Exact(C::KwNon, C::PWS)},
-						C::PWS
-					),
+					C::PKwAssociativity,
 					NumberLiteral(C::PWS),
 					Exact(C::SeqInfixTypeClose, C::PWS),
 					Exact(C::SeqInfixBind, C::PWS),
@@ -170,54 +198,41 @@ namespace funcc::nar {
 				},
 				C::PWS
 			),
-			[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				C::Values mv = std::dynamic_pointer_cast<MultiValue>(value)->GetValues();
-				std::shared_ptr<NumberLiteralValue> precedence = std::dynamic_pointer_cast<NumberLiteralValue>(mv[6]);
-				if (!precedence->IsInteger()) {
-					return std::make_shared<ErrorValue>(
-						precedence->GetRange(),
-						"Expected integer for infix operator precedence"
-					);
-				}
-				std::shared_ptr<SimpleValue> associativity = std::dynamic_pointer_cast<SimpleValue>(mv[5]);
-				Associativity assoc = Associativity::None;
-				if (associativity->GetValue() == C::KwLeft) {
-					assoc = Associativity::Left;
-				} else if (associativity->GetValue() == C::KwRight) {
-					assoc = Associativity::Right;
-				} else if (associativity->GetValue() == C::KwNon) {
-					assoc = Associativity::None;
-				}
+			MapInfix
+		);
 
-				return std::make_shared<InfixValue>(
-					value->GetRange(),
-					nar::Infix{
-						value->GetRange(),
-						std::dynamic_pointer_cast<C::InfixIdentifierValue>(mv[2])->GetValue(),
-						mv[2]->GetRange(),
-						!mv[1]->IsSkipped(),
-						assoc,
-						precedence->GetInteger(),
-						std::dynamic_pointer_cast<C::IdentifierValue>(mv[9])->GetValue(),
-					}
-				);
+		inline static std::shared_ptr<ITokenValue> MapDataConstructorParameter(
+			std::shared_ptr<ITokenValue> const& value
+		) {
+			MultiValue const& mv = value->As<MultiValue>();
+			Identifier name{};
+			SourceRange nameRange{};
+			if (!mv[0].IsSkipped()) {
+				ITokenValue const& nameValue = mv[0].As<MultiValue>()[0];
+				name = nameValue.As<C::IdentifierValue>().GetValue();
+				nameRange = nameValue.GetRange();
 			}
-		);
+			return std::make_shared<DataConstructorParameterValue>(
+				value->GetRange(),
+				nar::DataConstructorParameter{
+					.range = value->GetRange(),
+					.name = name,
+					.nameRange = nameRange,
+					.type = mv[1].As<T::TypeValue>().GetValue(),
+				}
+			);
+		}
 
+		// the name is kept only when it is followed by the annotation, a parameter without one is just its type
 		inline static std::shared_ptr<IToken> PDataConstructorParameter = Map(
-			All(C::Tokens{Optional(C::PIdentifier, Exact(C::SeqTypeAnnotation, C::PWS)), T::PType}, C::PWS),
-			[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				C::Values mv = std::dynamic_pointer_cast<MultiValue>(value)->GetValues();
-				return std::make_shared<DataConstructorParameterValue>(
-					value->GetRange(),
-					nar::DataConstructorParameter{
-						value->GetRange(),
-						mv[0]->IsSkipped() ? nullptr : std::dynamic_pointer_cast<C::IdentifierValue>(mv[0])->GetValue(),
-						mv[0]->GetRange(),
-						std::dynamic_pointer_cast<T::TypeValue>(mv[1])->GetValue(),
-					}
-				);
-			}
+			All(
+				C::Tokens{
+					Optional(All(C::Tokens{C::PIdentifier, Exact(C::SeqTypeAnnotation, C::PWS)}, C::PWS)),
+					T::PType
+				},
+				C::PWS
+			),
+			MapDataConstructorParameter
 		);
 
 		inline static std::shared_ptr<IToken> PDataConstructorParameters = Some(
@@ -228,6 +243,23 @@ namespace funcc::nar {
 			C::PWS
 		);
 
+		inline static std::shared_ptr<ITokenValue> MapDataConstructor(std::shared_ptr<ITokenValue> const& value) {
+			MultiValue const& mv = value->As<MultiValue>();
+			return std::make_shared<DataConstructorValue>(
+				value->GetRange(),
+				nar::DataConstructor{
+					value->GetRange(),
+					!mv[1].IsSkipped(),
+					mv[2].As<C::IdentifierValue>().GetValue(),
+					mv[2].GetRange(),
+					mv[3].IsSkipped()
+						? std::vector<nar::DataConstructorParameter>{}
+						: mv[3].As<MultiValue>().Extract<nar::DataConstructorParameter>(
+						  ),
+				}
+			);
+		}
+
 		inline static std::shared_ptr<IToken> PDataConstructor(bool first) {
 			return Map(
 				All(
@@ -239,22 +271,32 @@ namespace funcc::nar {
 					},
 					C::PWS
 				),
-				[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-					C::Values mv = std::dynamic_pointer_cast<MultiValue>(value)->GetValues();
-					return std::make_shared<DataConstructorValue>(
-						value->GetRange(),
-						nar::DataConstructor{
-							value->GetRange(),
-							!mv[1]->IsSkipped(),
-							std::dynamic_pointer_cast<C::IdentifierValue>(mv[2])->GetValue(),
-							mv[2]->GetRange(),
-							mv[3]->IsSkipped()
-								? std::vector<nar::DataConstructorParameter>{}
-								: std::dynamic_pointer_cast<MultiValue>(mv[3])->Extract<nar::DataConstructorParameter>(
-								  ),
-						}
-					);
-				}
+				MapDataConstructor
+			);
+		}
+
+		inline static std::shared_ptr<ITokenValue> MapData(std::shared_ptr<ITokenValue> const& value) {
+			MultiValue const& mv = value->As<MultiValue>();
+			std::vector<nar::DataConstructor> ctors =
+				mv[6].As<MultiValue>().Extract<nar::DataConstructor>();
+			ctors.insert(ctors.begin(), mv[5].As<DataConstructorValue>().GetValue());
+			std::vector<nar::Identifier> typeParams{};
+			if (!mv[3].IsSkipped()) {
+				// type parameters are mapped to variant types
+				typeParams = mv[3].As<MultiValue>().Extract<nar::Identifier>([](ITokenValue const& item) {
+					return static_cast<VarintType const&>(*item.As<T::TypeValue>().GetValue()).GetName();
+				});
+			}
+			return std::make_shared<DeclarationValue>(
+				value->GetRange(),
+				std::make_shared<nar::Data>(
+					value->GetRange(),
+					mv[2].As<C::IdentifierValue>().GetValue(),
+					mv[2].GetRange(),
+					!mv[1].IsSkipped(),
+					std::move(typeParams),
+					std::move(ctors)
+				)
 			);
 		}
 
@@ -271,25 +313,91 @@ namespace funcc::nar {
 				},
 				C::PWS
 			),
-			[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				C::Values mv = std::dynamic_pointer_cast<MultiValue>(value)->GetValues();
-				std::vector<nar::DataConstructor> ctors =
-					std::dynamic_pointer_cast<MultiValue>(mv[6])->Extract<nar::DataConstructor>();
-				ctors.insert(ctors.begin(), std::dynamic_pointer_cast<DataConstructorValue>(mv[5])->GetValue());
-				return std::make_shared<DataValue>(
-					value->GetRange(),
-					nar::Data{
-						value->GetRange(),
-						std::dynamic_pointer_cast<C::IdentifierValue>(mv[2])->GetValue(),
-						mv[2]->GetRange(),
-						!mv[1]->IsSkipped(),
-						mv[3]->IsSkipped() ? std::vector<nar::Identifier>{}
-										   : std::dynamic_pointer_cast<MultiValue>(mv[3])->Extract<nar::Identifier>(),
-						std::move(ctors),
+			MapData
+		);
+
+		inline static std::shared_ptr<ITokenValue> MapFunction(std::shared_ptr<ITokenValue> const& value) {
+			MultiValue const& mv = value->As<MultiValue>();
+			bool isHidden = !mv[1].IsSkipped();
+			MultiValue const& body = mv[2].As<MultiValue>();
+
+			Identifier name{};
+			SourceRange nameRange{};
+			P::FunctionSignature signature{};
+			std::shared_ptr<nar::IExpression> expr{};
+			std::shared_ptr<IType> type{};
+
+			switch (body.GetSize()) {
+				case 1: {  // native function
+					signature = body[0].As<P::FunctionSignatureValue>().GetValue();
+					bool typed = signature.returnType != nullptr;
+					for (auto const& param: signature.params) {
+						if (!param->GetType()) {
+							typed = false;
+							break;
+						}
+					}
+
+					if (!typed) {
+						return std::make_shared<ErrorValue>(value->GetRange(), "Expected type annotation");
 					}
+
+					break;
+				}
+				case 2: {  // native constant
+					name = body[0].As<C::IdentifierValue>().GetValue();
+					nameRange = body[0].GetRange();
+					if (body[1].IsSkipped()) {
+						return std::make_shared<ErrorValue>(value->GetRange(), "Expected type annotation");
+					}
+
+					type = body[1].As<T::TypeValue>().GetValue();
+					break;
+				}
+				case 3: {  // function
+					signature = body[0].As<P::FunctionSignatureValue>().GetValue();
+					expr = body[2].As<ExpressionValue>().GetValue();
+					break;
+				}
+				case 4: {  // constant
+					name = body[0].As<C::IdentifierValue>().GetValue();
+					if (!body[1].IsSkipped()) {
+						type = body[1].As<T::TypeValue>().GetValue();
+					}
+					nameRange = body[0].GetRange();
+					expr = body[3].As<ExpressionValue>().GetValue();
+				}
+			}
+
+			if (name.IsEmpty()) {
+				name = signature.name;
+				nameRange = signature.nameRange;
+
+				std::vector<std::shared_ptr<IType>> paramsTypes;
+				paramsTypes.reserve(signature.params.size());
+				for (auto const& param: signature.params) {
+					paramsTypes.push_back(param->GetType());
+				}
+				type = std::make_shared<nar::FunctionType>(
+					signature.range,
+					std::move(paramsTypes),
+					signature.returnType
 				);
 			}
-		);
+
+			return std::make_shared<DeclarationValue>(
+				value->GetRange(),
+				std::make_shared<nar::Function>(
+					value->GetRange(),
+					name,
+					nameRange,
+					isHidden,
+					signature.params,
+					type,
+					expr
+				)
+			);
+		}
 
 		inline static std::shared_ptr<IToken> PFunction = Map(
 			All(
@@ -325,121 +433,33 @@ namespace funcc::nar {
 				},
 				C::PWS
 			),
-			[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				C::Values mv = std::dynamic_pointer_cast<MultiValue>(value)->GetValues();
-				bool isHidden = !mv[1]->IsSkipped();
-				mv = std::dynamic_pointer_cast<MultiValue>(mv[2])->GetValues();
-
-				Identifier name{};
-				Range nameRange{};
-				P::FunctionSignature signature{};
-				std::shared_ptr<nar::IExpression> expr{};
-				std::shared_ptr<IType> type{};
-
-				switch (mv.size()) {
-					case 1: {  // native function
-						signature = std::dynamic_pointer_cast<P::FunctionSignatureValue>(mv[0])->GetValue();
-						bool typed = signature.returnType != nullptr;
-						for (auto const& param: signature.params) {
-							if (!param->GetType()) {
-								typed = false;
-								break;
-							}
-						}
-
-						if (!typed) {
-							return std::make_shared<ErrorValue>(value->GetRange(), "Expected type annotation");
-						}
-
-						break;
-					}
-					case 2: {  // native constant
-						name = std::dynamic_pointer_cast<C::IdentifierValue>(mv[0])->GetValue();
-						nameRange = mv[0]->GetRange();
-						if (mv[1]->IsSkipped()) {
-							return std::make_shared<ErrorValue>(value->GetRange(), "Expected type annotation");
-						}
-
-						type = std::dynamic_pointer_cast<T::TypeValue>(mv[1])->GetValue();
-						break;
-					}
-					case 3: {  // function
-						signature = std::dynamic_pointer_cast<P::FunctionSignatureValue>(mv[0])->GetValue();
-						expr = std::dynamic_pointer_cast<ExpressionValue>(mv[2])->GetValue();
-						break;
-					}
-					case 4: {  // constant
-						name = std::dynamic_pointer_cast<C::IdentifierValue>(mv[0])->GetValue();
-						if (!mv[1]->IsSkipped()) {
-							type = std::dynamic_pointer_cast<T::TypeValue>(mv[1])->GetValue();
-						}
-						nameRange = mv[0]->GetRange();
-						expr = std::dynamic_pointer_cast<ExpressionValue>(mv[3])->GetValue();
-					}
-				}
-
-				if (name.empty()) {
-					name = signature.name;
-					nameRange = signature.nameRange;
-
-					std::vector<std::shared_ptr<IType>> paramsTypes;
-					paramsTypes.reserve(signature.params.size());
-					for (auto const& param: signature.params) {
-						paramsTypes.push_back(param->GetType());
-					}
-					type = std::make_shared<nar::FunctionType>(
-						signature.range,
-						std::move(paramsTypes),
-						signature.returnType
-					);
-				}
-
-				return std::make_shared<FunctionValue>(
-					value->GetRange(),
-					nar::Function{
-						value->GetRange(),
-						name,
-						nameRange,
-						isHidden,
-						signature.params,
-						type,
-						expr,
-					}
-				);
-			}
+			MapFunction
 		);
 
 		inline static std::shared_ptr<IToken> PDeclarations = Repeat(
-			OneOf(
-				C::Tokens{
-					Exact(C::KwAlias, C::PWS),
-					Exact(C::KwInfix, C::PWS),
-					Exact(C::KwData, C::PWS),
-					Exact(C::KwDef, C::PWS)
-				},
-				C::PWS
-			),
+			C::PKwDeclaration,
 			OneOf(C::Tokens{PAlias, PInfix, PData, PFunction}, C::PWS),
 			C::PWS,
 			true
 		);
 
+		inline static std::shared_ptr<ITokenValue> MapFile(std::shared_ptr<ITokenValue> const& value) {
+			MultiValue const& mv = value->As<MultiValue>();
+
+			return std::make_shared<FileValue>(
+				value->GetRange(),
+				File{
+					.module = mv[0].As<C::QualifiedIdentifierValue>().GetValue(),
+					.moduleRange = mv[0].GetRange(),
+					.imports = mv[1].As<MultiValue>().Extract<nar::Import>(),
+					.declarations = mv[2].As<MultiValue>().Extract<std::shared_ptr<IDeclaration>>(),
+				}
+			);
+		}
+
 		inline static std::shared_ptr<IToken> PFile = Map(
 			All(C::Tokens{PModule, PImports, PDeclarations, Eof(C::PWS)}, C::PWS),
-			[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				C::Values mv = std::dynamic_pointer_cast<MultiValue>(value)->GetValues();
-
-				return std::make_shared<FileValue>(
-					value->GetRange(),
-					File{
-						.module = std::dynamic_pointer_cast<C::QualifiedIdentifierValue>(mv[0])->GetValue(),
-						.moduleRange = mv[0]->GetRange(),
-						.imports = std::dynamic_pointer_cast<MultiValue>(mv[1])->Extract<nar::Import>(),
-						.declarations =
-							std::dynamic_pointer_cast<MultiValue>(mv[2])->Extract<std::shared_ptr<IDeclaration>>(),
-					}
-				);
-			}
+			MapFile
 		);
 	};
 }
@@ -0,0 +1,533 @@
+#pragma once
+
+#include "../_external.hh"
+#include "../fixed_parser.hh"
+#include "parser_file.hh"
+
+// The grammar of FileParser built from fixed nodes. It uses the same leaf tokens and mappers, so both engines
+// accept the same language and build the same values. Changes to the grammar go to both.
+namespace funcc::nar {
+	using namespace funcc::parser;
+
+	class FixedCommonParser {
+		using C = CommonParser;
+
+	public:
+		inline static auto const PQualifiedIdentifier =
+			fixed::Map<&C::MapQualifiedIdentifier>(fixed::Use<WordToken>(C::LxQualifiedIdentifier));
+
+		inline static auto const PIdentifier = fixed::Map<&C::MapIdentifier>(fixed::Use<WordToken>(C::LxIdentifier));
+
+		inline static auto const PInfixIdentifier =
+			fixed::Map<&C::MapInfixIdentifier>(fixed::Use<WordToken>(C::LxInfixIdentifier));
+
+		inline static auto const PWrappedInfixIdentifier = fixed::Map<&C::MapWrappedInfixIdentifier>(fixed::All(
+			fixed::Exact(C::SeqInfixOpen, C::PWS),
+			PInfixIdentifier,
+			fixed::Exact(C::SeqInfixClose, C::PWS)
+		));
+
+		inline static auto const PConst = fixed::OneOf(
+			C::PWS,
+			fixed::Map<&C::MapConstChar>(fixed::Use<StringLiteralToken>(C::LxChar)),
+			fixed::Map<&C::MapConstNumber>(fixed::Use<NumberLiteralToken>(C::LxNumber)),
+			fixed::Map<&C::MapConstString>(fixed::Use<StringLiteralToken>(C::LxString)),
+			fixed::Map<&C::MapConstUnit>(fixed::Exact(C::SeqUnitType, C::PWS))
+		);
+	};
+
+	class FixedTypeParser {
+		using C = CommonParser;
+		using T = TypeParser;
+		using FC = FixedCommonParser;
+
+		struct TypeRule {
+			static auto const& Alternatives();
+		};
+
+	public:
+		inline static auto const PType = fixed::Rule<TypeRule>();
+
+		inline static auto const PTypeParameters = fixed::Some(
+			fixed::Map<&T::MapTypeParameter>(FC::PIdentifier),
+			fixed::Exact(C::SeqTypeParametersOpen, C::PWS),
+			fixed::Exact(C::SeqTypeParametersClose, C::PWS),
+			fixed::Exact(C::SeqTypeParametersSep, C::PWS),
+			C::PWS
+		);
+
+		inline static auto const PTypeAnnotation =
+			fixed::Map<&T::MapTypeAnnotation>(fixed::All(fixed::Exact(C::SeqTypeAnnotation, C::PWS), PType));
+
+		inline static auto const PFunctionType = fixed::Map<&T::MapFunctionType>(fixed::All(
+			fixed::Some(
+				PType,
+				fixed::Exact(C::SeqFuncOpen, C::PWS),
+				fixed::Exact(C::SeqFuncClose, C::PWS),
+				fixed::Exact(C::SeqFuncSep, C::PWS),
+				C::PWS
+			),
+			PTypeAnnotation
+		));
+
+		inline static auto const PNamedType =
+			fixed::Map<&T::MapNamedType>(fixed::All(FC::PIdentifier, fixed::Optional(PTypeParameters)));
+
+		inline static auto const PVariantType = fixed::Map<&T::MapVariantType>(FC::PIdentifier);
+
+		inline static auto const PRecordType = fixed::Map<&T::MapRecordType>(fixed::Some(
+			fixed::All(FC::PIdentifier, PTypeAnnotation),
+			fixed::Exact(C::SeqRecordOpen, C::PWS),
+			fixed::Exact(C::SeqRecordClose, C::PWS),
+			fixed::Exact(C::SeqRecordSep, C::PWS),
+			C::PWS
+		));
+
+		inline static auto const PTupleType = fixed::Map<&T::MapTupleType>(fixed::Some(
+			PType,
+			fixed::Exact(C::SeqTupleOpen, C::PWS),
+			fixed::Exact(C::SeqTupleClose, C::PWS),
+			fixed::Exact(C::SeqTupleSep, C::PWS),
+			C::PWS
+		));
+
+		inline static auto const PUnitType = fixed::Map<&T::MapUnitType>(fixed::Exact(C::SeqUnitType, C::PWS));
+
+	private:
+		inline static auto const PTypeAlternatives =
+			fixed::OneOf(C::PWS, PFunctionType, PNamedType, PVariantType, PRecordType, PTupleType, PUnitType);
+	};
+
+	inline auto const& FixedTypeParser::TypeRule::Alternatives() {
+		return PTypeAlternatives;
+	}
+
+	class FixedPatternParser {
+		using C = CommonParser;
+		using P = PatternParser;
+		using FC = FixedCommonParser;
+		using FT = FixedTypeParser;
+
+		struct PatternRule {
+			static auto const& Alternatives();
+		};
+
+	public:
+		inline static auto const PPattern = fixed::Rule<PatternRule>();
+
+		inline static auto const PAlias = fixed::Map<&P::MapAlias>(fixed::All(
+			PPattern,
+			fixed::Exact(C::KwAs, C::PWS),
+			FC::PIdentifier,
+			fixed::Optional(FT::PTypeAnnotation)
+		));
+
+		inline static auto const PAny = fixed::Map<&P::MapAny>(fixed::Exact(C::SeqPatternAny, C::PWS));
+
+		inline static auto const PCons = fixed::Map<&P::MapCons>(fixed::All(
+			PPattern,
+			fixed::Exact(C::SeqCons, C::PWS),
+			PPattern,
+			fixed::Optional(FT::PTypeAnnotation)
+		));
+
+		inline static auto const PConst =
+			fixed::Map<&P::MapConst>(fixed::All(FC::PConst, fixed::Optional(FT::PTypeAnnotation)));
+
+		inline static auto const PNamed =
+			fixed::Map<&P::MapNamed>(fixed::All(FC::PIdentifier, fixed::Optional(FT::PTypeAnnotation)));
+
+		inline static auto const PDataConstructor = fixed::Map<&P::MapDataConstructor>(fixed::All(
+			FC::PQualifiedIdentifier,
+			fixed::Some(
+				PPattern,
+				fixed::Exact(C::SeqFuncOpen, C::PWS),
+				fixed::Exact(C::SeqFuncClose, C::PWS),
+				fixed::Exact(C::SeqFuncSep, C::PWS),
+				C::PWS,
+				fixed::None{},
+				true
+			),
+			fixed::Optional(FT::PTypeAnnotation)
+		));
+
+		inline static auto const PList = fixed::Map<&P::MapList>(fixed::All(
+			fixed::Some(
+				PPattern,
+				fixed::Exact(C::SeqListOpen, C::PWS),
+				fixed::Exact(C::SeqListClose, C::PWS),
+				fixed::Exact(C::SeqListSep, C::PWS),
+				C::PWS,
+				fixed::None{},
+				true
+			),
+			fixed::Optional(FT::PTypeAnnotation)
+		));
+
+		inline static auto const PRecord = fixed::Map<&P::MapRecord>(fixed::All(
+			fixed::Some(
+				FC::PIdentifier,
+				fixed::Exact(C::SeqRecordOpen, C::PWS),
+				fixed::Exact(C::SeqRecordClose, C::PWS),
+				fixed::Exact(C::SeqRecordSep, C::PWS),
+				C::PWS
+			),
+			fixed::Optional(FT::PTypeAnnotation)
+		));
+
+		inline static auto const PTuple = fixed::Map<&P::MapTuple>(fixed::All(
+			fixed::Some(
+				PPattern,
+				fixed::Exact(C::SeqTupleOpen, C::PWS),
+				fixed::Exact(C::SeqTupleClose, C::PWS),
+				fixed::Exact(C::SeqTupleSep, C::PWS),
+				C::PWS
+			),
+			fixed::Optional(FT::PTypeAnnotation)
+		));
+
+		inline static auto const PFunctionSignature = fixed::Map<&P::MapFunctionSignature>(fixed::All(
+			FC::PIdentifier,
+			fixed::Optional(fixed::Some(
+				PPattern,
+				fixed::Exact(C::SeqFuncOpen, C::PWS),
+				fixed::Exact(C::SeqFuncClose, C::PWS),
+				fixed::Exact(C::SeqFuncSep, C::PWS),
+				C::PWS
+			)),
+			fixed::Optional(FT::PTypeAnnotation)
+		));
+
+	private:
+		inline static auto const PPatternAlternatives = fixed::OneOf(
+			C::PWS,
+			PAlias,
+			PAny,
+			PCons,
+			PConst,
+			PNamed,
+			PDataConstructor,
+			PList,
+			PRecord,
+			PTuple
+		);
+	};
+
+	inline auto const& FixedPatternParser::PatternRule::Alternatives() {
+		return PPatternAlternatives;
+	}
+
+	class FixedExpressionParser {
+		using C = CommonParser;
+		using E = ExpressionParser;
+		using FC = FixedCommonParser;
+		using FT = FixedTypeParser;
+		using FP = FixedPatternParser;
+
+		struct ExpressionRule {
+			static auto const& Alternatives();
+		};
+
+		struct LetRule {
+			static auto const& Alternatives();
+		};
+
+	public:
+		inline static auto const PExpression = fixed::Rule<ExpressionRule>();
+		inline static auto const PLet = fixed::Rule<LetRule>();
+
+		inline static auto const PAccessor =
+			fixed::Map<&E::MapAccessor>(fixed::All(fixed::Exact(C::SeqAccessor, C::PWS), FC::PIdentifier));
+
+		inline static auto const PAccess =
+			fixed::Map<&E::MapAccess>(fixed::All(PExpression, fixed::Exact(C::SeqAccessor, C::PWS), FC::PIdentifier));
+
+		inline static auto const PApply = fixed::Map<&E::MapApply>(fixed::All(
+			PExpression,
+			fixed::Some(
+				PExpression,
+				fixed::Exact(C::SeqFuncOpen, C::PWS),
+				fixed::Exact(C::SeqFuncClose, C::PWS),
+				fixed::Exact(C::SeqFuncSep, C::PWS),
+				C::PWS
+			)
+		));
+
+		inline static auto const PBinOp =
+			fixed::Map<&E::MapBinOp>(fixed::All(PExpression, FC::PInfixIdentifier, PExpression));
+
+		inline static auto const PConst = fixed::Map<&E::MapConst>(FC::PConst);
+
+		inline static auto const PIf = fixed::Map<&E::MapIf>(fixed::All(
+			fixed::Exact(C::KwIf, C::PWS),
+			PExpression,
+			fixed::Exact(C::KwThen, C::PWS),
+			PExpression,
+			fixed::Exact(C::KwElse, C::PWS),
+			PExpression
+		));
+
+		inline static auto const PInfix = fixed::Map<&E::MapInfix>(FC::PWrappedInfixIdentifier);
+
+		inline static auto const PLambda = fixed::Map<&E::MapLambda>(fixed::All(
+			fixed::Exact(C::SeqLambdaSignature, C::PWS),
+			fixed::Some(
+				FP::PPattern,
+				fixed::None{},
+				fixed::Exact(C::SeqFuncClose, C::PWS),
+				fixed::Exact(C::SeqFuncSep, C::PWS),
+				C::PWS
+			),
+			fixed::Optional(FT::PTypeAnnotation),
+			fixed::Exact(C::SeqLambdaBind, C::PWS),
+			PExpression
+		));
+
+		inline static auto const PLetIn =
+			fixed::Map<&E::MapLetIn>(fixed::All(fixed::Exact(C::KwIn, C::PWS), PExpression));
+
+		inline static auto const PLetFunction = fixed::Map<&E::MapLetFunction>(fixed::All(
+			fixed::Exact(C::KwLet, C::PWS),
+			FP::PFunctionSignature,
+			fixed::Exact(C::SeqFunctionBind, C::PWS),
+			PExpression,
+			fixed::OneOf(C::PWS, PLetIn, PLet)
+		));
+
+		inline static auto const PLetValue = fixed::Map<&E::MapLetValue>(fixed::All(
+			fixed::Exact(C::KwLet, C::PWS),
+			FP::PPattern,
+			fixed::Exact(C::SeqFunctionBind, C::PWS),
+			PExpression,
+			fixed::OneOf(C::PWS, PLetIn, PLet)
+		));
+
+		inline static auto const PList = fixed::Map<&E::MapList>(fixed::Some(
+			PExpression,
+			fixed::Exact(C::SeqListOpen, C::PWS),
+			fixed::Exact(C::SeqListClose, C::PWS),
+			fixed::Exact(C::SeqListSep, C::PWS),
+			C::PWS,
+			fixed::None{},  // firstItem
+			true  // allowEmpty
+		));
+
+		inline static auto const PNegate =
+			fixed::Map<&E::MapNegate>(fixed::All(fixed::Exact(C::SeqNegate, C::PWS), PExpression));
+
+		inline static auto const PRecord = fixed::Map<&E::MapRecord>(fixed::Some(
+			fixed::All(FC::PIdentifier, fixed::Exact(C::SeqRecordBind, C::PWS), PExpression),
+			fixed::Exact(C::SeqRecordOpen, C::PWS),
+			fixed::Exact(C::SeqRecordClose, C::PWS),
+			fixed::Exact(C::SeqRecordSep, C::PWS),
+			C::PWS,
+			fixed::None{},  // firstItem
+			true  // allowEmpty
+		));
+
+		inline static auto const PSelect = fixed::Map<&E::MapSelect>(fixed::All(
+			fixed::Exact(C::KwSelect, C::PWS),
+			PExpression,
+			fixed::Repeat(
+				fixed::Exact(C::KwCase, C::PWS),
+				fixed::All(
+					fixed::Exact(C::KwCase, C::PWS),
+					FP::PPattern,
+					fixed::Exact(C::SeqCaseBind, C::PWS),
+					PExpression
+				),
+				C::PWS
+			),
+			fixed::Exact(C::KwEnd, C::PWS)
+		));
+
+		inline static auto const PTuple = fixed::Map<&E::MapTuple>(fixed::Some(
+			PExpression,
+			fixed::Exact(C::SeqTupleOpen, C::PWS),
+			fixed::Exact(C::SeqTupleClose, C::PWS),
+			fixed::Exact(C::SeqTupleSep, C::PWS),
+			C::PWS
+		));
+
+		inline static auto const PUpdate = fixed::Map<&E::MapUpdate>(fixed::All(
+			fixed::Exact(C::SeqRecordOpen, C::PWS),
+			PExpression,
+			fixed::Exact(C::SeqRecordUpdate, C::PWS),
+			fixed::Some(
+				fixed::All(FC::PIdentifier, fixed::Exact(C::SeqRecordBind, C::PWS), PExpression),
+				fixed::None{},  // prefix
+				fixed::None{},  // suffix
+				fixed::Exact(C::SeqRecordSep, C::PWS),
+				C::PWS
+			),
+			fixed::Exact(C::SeqRecordClose, C::PWS)
+		));
+
+		inline static auto const PVar = fixed::Map<&E::MapVar>(FC::PQualifiedIdentifier);
+
+	private:
+		inline static auto const PExpressionAlternatives = fixed::OneOf(
+			C::PWS,
+			PAccessor,
+			PAccess,
+			PApply,
+			PBinOp,
+			PConst,
+			PIf,
+			PInfix,
+			PLambda,
+			PLet,
+			PList,
+			PNegate,
+			PRecord,
+			PSelect,
+			PTuple,
+			PUpdate,
+			PVar
+		);
+
+		inline static auto const PLetAlternatives = fixed::OneOf(C::PWS, PLetFunction, PLetValue);
+	};
+
+	inline auto const& FixedExpressionParser::ExpressionRule::Alternatives() {
+		return PExpressionAlternatives;
+	}
+
+	inline auto const& FixedExpressionParser::LetRule::Alternatives() {
+		return PLetAlternatives;
+	}
+
+	class FixedFileParser {
+		using C = CommonParser;
+		using F = FileParser;
+		using FC = FixedCommonParser;
+		using FT = FixedTypeParser;
+		using FP = FixedPatternParser;
+		using FE = FixedExpressionParser;
+
+	public:
+		inline static auto const PModule =
+			fixed::Map<&F::MapModule>(fixed::All(fixed::Exact(C::KwModule, C::PWS), FC::PQualifiedIdentifier));
+
+		inline static auto const PImportExposing = fixed::OneOf(
+			C::PWS,
+			fixed::Exact(C::SeqExposingAll, C::PWS),
+			fixed::Some(
+				FC::PIdentifier,
+				fixed::Exact(C::SeqImportListOpen, C::PWS),
+				fixed::Exact(C::SeqImportListClose, C::PWS),
+				fixed::Exact(C::SeqImportListSep, C::PWS),
+				C::PWS
+			)
+		);
+
+		inline static auto const PImport = fixed::Map<&F::MapImport>(fixed::All(
+			fixed::Exact(C::KwImport, C::PWS),
+			FC::PQualifiedIdentifier,
+			fixed::Optional(fixed::All(fixed::Exact(C::KwAs, C::PWS), FC::PIdentifier)),
+			fixed::Optional(fixed::All(fixed::Exact(C::KwExposing, C::PWS), PImportExposing))
+		));
+
+		inline static auto const PImports = fixed::Repeat(fixed::Exact(C::KwImport, C::PWS), PImport, C::PWS, true);
+
+		inline static auto const PAlias = fixed::Map<&F::MapAlias>(fixed::All(
+			fixed::Exact(C::KwAlias, C::PWS),
+			fixed::Optional(fixed::Exact(C::KwHidden, C::PWS)),
+			fixed::Optional(
+				fixed::Exact(C::KwNative, C::PWS),
+				fixed::All(FC::PIdentifier, fixed::Optional(FT::PTypeParameters)),
+				fixed::All(
+					FC::PIdentifier,
+					fixed::Optional(FT::PTypeParameters),
+					fixed::Exact(C::SeqAliasBind, C::PWS),
+					FT::PType
+				)
+			)
+		));
+
+		inline static auto const PInfix = fixed::Map<&F::MapInfix>(fixed::All(
+			fixed::Exact(C::KwInfix, C::PWS),
+			fixed::Optional(fixed::Exact(C::KwHidden, C::PWS)),
+			FC::PWrappedInfixIdentifier,
+			fixed::Exact(C::SeqInfixTypeDecl, C::PWS),
+			fixed::Exact(C::SeqInfixTypeOpen, C::PWS),
+			fixed::Use<LiteralSetToken>(C::PKwAssociativity),
+			fixed::Use<NumberLiteralToken>(NumberLiteral(C::PWS)),
+			fixed::Exact(C::SeqInfixTypeClose, C::PWS),
+			fixed::Exact(C::SeqInfixBind, C::PWS),
+			FC::PIdentifier
+		));
+
+		inline static auto const PDataConstructorParameter = fixed::Map<&F::MapDataConstructorParameter>(fixed::All(
+			fixed::Optional(fixed::All(FC::PIdentifier, fixed::Exact(C::SeqTypeAnnotation, C::PWS))),
+			FT::PType
+		));
+
+		inline static auto const PDataConstructorParameters = fixed::Some(
+			PDataConstructorParameter,
+			fixed::Exact(C::SeqFuncOpen, C::PWS),
+			fixed::Exact(C::SeqFuncClose, C::PWS),
+			fixed::Exact(C::SeqFuncSep, C::PWS),
+			C::PWS
+		);
+
+		// the separator is optional before the first constructor
+		inline static auto const PFirstDataConstructor = fixed::Map<&F::MapDataConstructor>(fixed::All(
+			fixed::Optional(fixed::Exact(C::SeqDataConstructor, C::PWS)),
+			fixed::Optional(fixed::Exact(C::KwHidden, C::PWS)),
+			FC::PIdentifier,
+			fixed::Optional(PDataConstructorParameters)
+		));
+
+		inline static auto const PDataConstructor = fixed::Map<&F::MapDataConstructor>(fixed::All(
+			fixed::Exact(C::SeqDataConstructor, C::PWS),
+			fixed::Optional(fixed::Exact(C::KwHidden, C::PWS)),
+			FC::PIdentifier,
+			fixed::Optional(PDataConstructorParameters)
+		));
+
+		inline static auto const PData = fixed::Map<&F::MapData>(fixed::All(
+			fixed::Exact(C::KwData, C::PWS),
+			fixed::Optional(fixed::Exact(C::KwHidden, C::PWS)),
+			FC::PIdentifier,
+			fixed::Optional(FT::PTypeParameters),
+			fixed::Exact(C::SeqDataBind, C::PWS),
+			PFirstDataConstructor,
+			fixed::Repeat(fixed::Exact(C::SeqDataConstructor, C::PWS), PDataConstructor, C::PWS, true)
+		));
+
+		inline static auto const PFunction = fixed::Map<&F::MapFunction>(fixed::All(
+			fixed::Exact(C::KwDef, C::PWS),
+			fixed::Optional(fixed::Exact(C::KwHidden, C::PWS)),
+			fixed::Optional(
+				fixed::Exact(C::KwNative, C::PWS),
+				fixed::OneOf(
+					C::PWS,
+					fixed::All(FC::PIdentifier, FT::PTypeAnnotation),
+					fixed::All(FP::PFunctionSignature)
+				),
+				fixed::OneOf(
+					C::PWS,
+					fixed::All(
+						FC::PIdentifier,
+						fixed::Optional(FT::PTypeAnnotation),
+						fixed::Exact(C::SeqFunctionBind, C::PWS),
+						FE::PExpression
+					),
+					fixed::All(FP::PFunctionSignature, fixed::Exact(C::SeqFunctionBind, C::PWS), FE::PExpression)
+				)
+			)
+		));
+
+		inline static auto const PDeclarations = fixed::Repeat(
+			fixed::Use<LiteralSetToken>(C::PKwDeclaration),
+			fixed::OneOf(C::PWS, PAlias, PInfix, PData, PFunction),
+			C::PWS,
+			true
+		);
+
+		inline static auto const PFile = fixed::Map<&F::MapFile>(
+			fixed::All(PModule, PImports, PDeclarations, fixed::Use<EOFToken>(Eof(C::PWS)))
+		);
+	};
+}
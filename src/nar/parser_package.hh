@@ -1,22 +1,237 @@
 #pragma once
 
 #include "../_external.hh"
+#include "../bundle.hh"
+#include "../machine.hh"
+#include "../source_manager.hh"
+#include "../thread_pool.hh"
 #include "ast_common.hh"
 #include "parser_file.hh"
+#include "parser_fixed.hh"
 
 namespace funcc::nar {
 	class PackageParser {
 	public:
+		// the grammar files are parsed with: FileParser, its port to fixed nodes FixedFileParser, or FileParser
+		// compiled for the parsing machine
+		enum class Engine {
+			Tokens,
+			Fixed,
+			Machine
+		};
+
+	private:
+		size_t m_memoCapacity;
+		Engine m_engine;
+		MemoStats m_memoStats{};
+		SourceManager m_sources{};
+
+	public:
+		// memoCapacity limits the number of cached token results per file, 0 disables memoization but for the seeds of
+		// left recursive rules
+		explicit PackageParser(size_t memoCapacity = MemoTable::DefaultCapacity, Engine engine = Engine::Tokens) :
+			m_memoCapacity{memoCapacity},
+			m_engine{engine} {}
+
 		std::shared_ptr<ITokenValue> ParseFile(std::string const& filePath) {
-			std::ifstream fileStream{filePath};
-			if (!fileStream.is_open()) {
-				return std::make_shared<ErrorValue>(std::string("Failed to open file ") + filePath);
+			FileId file = m_sources.Reserve(filePath);
+			if (std::shared_ptr<ITokenValue> error = Load(file)) {
+				return error;
+			}
+			return Parse(file, m_memoStats);
+		}
+
+		struct PackageFile {
+			std::string path;
+			// the file value, or the error of the file
+			std::shared_ptr<ITokenValue> result;
+			// the memo table of this file alone, zero if the file could not be loaded
+			MemoStats stats{};
+		};
+
+		// Parses every .nar file under the root directory, threads 0 uses all hardware threads. A file is read by the
+		// thread that parses it, so reads of many small files wait in parallel and each parse starts as soon as its
+		// file is in. The files run in no fixed order, but the i-th result always belongs to the i-th path in sorted
+		// order.
+		std::vector<PackageFile> ParsePackage(std::string const& root, size_t threads = 0) {
+			std::vector<std::string> paths{};
+			if (!FindSources(root, paths)) {
+				return {
+					PackageFile{root, std::make_shared<ErrorValue>(std::string("Failed to read directory ") + root)}
+				};
+			}
+
+			// ids are given in path order before any thread starts, the sources are not added to while loading
+			std::vector<PackageFile> results{};
+			std::vector<FileId> files{};
+			for (auto& path: paths) {
+				files.push_back(m_sources.Reserve(path));
+				results.push_back(PackageFile{std::move(path), nullptr});
+			}
+			ParseAll(results, threads, [this, &files](size_t i) { return std::make_pair(files[i], Load(files[i])); });
+			return results;
+		}
+
+		// Parses the modules of a bundle written by WriteBundle straight out of one mapping of it, like ParsePackage.
+		// A module is named by the bundle path and its name in the bundle, its source is checked against its hash.
+		std::vector<PackageFile> ParseBundle(std::string const& bundlePath, size_t threads = 0) {
+			std::string_view data{};
+			if (!m_sources.LoadShared(bundlePath, data)) {
+				return {PackageFile{bundlePath, std::make_shared<ErrorValue>("Failed to open file " + bundlePath)}};
+			}
+			std::vector<Bundle::Module> modules{};
+			if (!Bundle::ReadIndex(data, modules)) {
+				return {PackageFile{bundlePath, std::make_shared<ErrorValue>("Invalid bundle " + bundlePath)}};
+			}
+
+			std::vector<PackageFile> results{};
+			std::vector<FileId> files{};
+			for (auto const& module: modules) {
+				std::string path = bundlePath + "/" + std::string{module.name};
+				files.push_back(m_sources.Reserve(path));
+				results.push_back(PackageFile{std::move(path), nullptr});
+			}
+			using Loaded = std::pair<FileId, std::shared_ptr<ITokenValue>>;
+			ParseAll(results, threads, [this, &files, &modules, data](size_t i) -> Loaded {
+				Bundle::Module const& module = modules[i];
+				std::string_view source = data.substr(module.offset, module.length);
+				m_sources.Load(files[i], source);
+				if (Bundle::Hash(source) != module.hash) {
+					return Loaded{files[i], std::make_shared<ErrorValue>("Source does not match its hash")};
+				}
+				return Loaded{files[i], CheckContent(files[i])};
+			});
+			return results;
+		}
+
+		// Writes the .nar files under the root into a bundle, in path order. The error if a file cannot be read or the
+		// bundle cannot be written.
+		std::shared_ptr<ITokenValue> WriteBundle(std::string const& root, std::string const& bundlePath) {
+			std::vector<std::string> paths{};
+			if (!FindSources(root, paths)) {
+				return std::make_shared<ErrorValue>(std::string("Failed to read directory ") + root);
+			}
+			std::vector<std::pair<std::string, std::string_view>> modules{};
+			for (auto const& path: paths) {
+				FileId file = m_sources.Reserve(path);
+				if (!m_sources.Load(file)) {
+					return std::make_shared<ErrorValue>("Failed to open file " + path);
+				}
+				if (m_sources.IsTooLarge(file)) {
+					return std::make_shared<ErrorValue>("Source is larger than 4 GiB: " + path);
+				}
+				std::string name = std::filesystem::path{path}.lexically_relative(root).generic_string();
+				modules.emplace_back(std::move(name), m_sources.GetContent(file));
+			}
+			if (!Bundle::Write(bundlePath, modules)) {
+				return std::make_shared<ErrorValue>("Failed to write file " + bundlePath);
 			}
+			return nullptr;
+		}
 
-			std::string fileContent{std::istreambuf_iterator<char>(fileStream), std::istreambuf_iterator<char>()};
-			Utf8Reader reader{fileContent};
+		// compiled on first use and shared by all parsers
+		[[nodiscard]] static Machine const& GetFileMachine() {
+			static Machine const machine{ProgramBuilder::Build(*FileParser::PFile)};
+			return machine;
+		}
 
-			return FileParser::PFile->Consume(reader);
+		// statistics of the memo table used by the last ParseFile call, or the sum of the stats of the files of the
+		// last ParsePackage or ParseBundle call
+		[[nodiscard]] MemoStats const& GetMemoStats() const {
+			return m_memoStats;
+		}
+
+		// every file parsed so far, the ranges of the results resolve through it
+		[[nodiscard]] SourceManager const& GetSources() const {
+			return m_sources;
+		}
+
+	private:
+		// the .nar files under the root sorted by path, false if the directory cannot be read
+		static bool FindSources(std::string const& root, std::vector<std::string>& outPaths) {
+			std::error_code error{};
+			std::filesystem::recursive_directory_iterator it{root, error};
+			for (; !error && it != std::filesystem::recursive_directory_iterator{}; it.increment(error)) {
+				if (it->is_regular_file() && it->path().extension() == ".nar") {
+					outPaths.push_back(it->path().string());
+				}
+			}
+			std::sort(outPaths.begin(), outPaths.end());
+			return !error;
+		}
+
+		// Loads and parses the files on the pool, load(i) gives the id of the i-th file and the error if it could not
+		// be loaded. A job writes only the slots of its own file, so the results and the memo statistics, which are
+		// kept per file and summed in file order, do not depend on how the jobs were scheduled.
+		template<typename F>
+		void ParseAll(std::vector<PackageFile>& results, size_t threads, F&& load) {
+			std::vector<size_t> order{};
+			for (size_t i = 0; i < results.size(); ++i) {
+				order.push_back(i);
+			}
+
+			ThreadPool{threads}.ForEach(order, [this, &results, &load](size_t i) {
+				auto [file, error] = load(i);
+				results[i].result = error ? std::move(error) : Parse(file, results[i].stats);
+			});
+
+			m_memoStats = MemoStats{};
+			for (auto const& result: results) {
+				m_memoStats.hits += result.stats.hits;
+				m_memoStats.misses += result.stats.misses;
+				m_memoStats.evictions += result.stats.evictions;
+			}
+		}
+
+		// reads a reserved file, the error if it cannot be read, is too large or is not UTF-8
+		std::shared_ptr<ITokenValue> Load(FileId file) {
+			if (!m_sources.Load(file)) {
+				std::string message{"Failed to open file "};
+				message += m_sources.GetPath(file);
+				return std::make_shared<ErrorValue>(std::move(message));
+			}
+			return CheckContent(file);
+		}
+
+		// the error if a loaded source is too large for its locations or is not UTF-8
+		[[nodiscard]] std::shared_ptr<ITokenValue> CheckContent(FileId file) const {
+			if (m_sources.IsTooLarge(file)) {
+				return std::make_shared<ErrorValue>("Source is larger than 4 GiB");
+			}
+			if (size_t invalid = m_sources.GetInvalidUtf8(file); invalid != Utf8::Valid) {
+				Location at{invalid, file};
+				return std::make_shared<ErrorValue>(Range{at, at}, "Invalid UTF-8");
+			}
+			return nullptr;
+		}
+
+		// only reads the parser, files of a package are parsed by several threads at once
+		std::shared_ptr<ITokenValue> Parse(FileId file, MemoStats& outStats) const {
+			std::string_view content = m_sources.GetContent(file);
+			bool ascii = m_sources.IsAscii(file);
+			TokenStream tokens = CommonParser::Lexicon.Lex(content, ascii);
+			ParseContext context{&tokens, m_memoCapacity};
+			Utf8Reader reader{content, file, ascii};
+
+			std::shared_ptr<ITokenValue> result{};
+			switch (m_engine) {
+				case Engine::Tokens:
+					result = FileParser::PFile->Consume(reader, context);
+					break;
+				case Engine::Fixed:
+					result = FixedFileParser::PFile.Consume(reader, context);
+					break;
+				case Engine::Machine:
+					result = GetFileMachine().Run(reader, context);
+					break;
+			}
+			outStats = context.GetMemoStats();
+
+			// the file value comes from the PFile mapper on the heap, the error is built from the fatal or furthest failure
+			if (result->HasError() || context.GetFailures().HasFatal()) {
+				return context.GetFailures().MakeError();
+			}
+			return result;
 		}
 	};
 }
@@ -14,9 +14,9 @@ namespace funcc::nar {
 
 	public:
 		struct FunctionSignature {
-			Range range;
+			SourceRange range;
 			Identifier name;
-			Range nameRange;
+			SourceRange nameRange;
 			std::vector<std::shared_ptr<IPattern>> params;
 			std::shared_ptr<IType> returnType;
 		};
@@ -26,78 +26,99 @@ namespace funcc::nar {
 
 		inline static std::shared_ptr<IToken> PPattern = ForwardDeclaration();
 
+		inline static std::shared_ptr<ITokenValue> MapAlias(std::shared_ptr<ITokenValue> const& value) {
+			MultiValue const& mv = value->As<MultiValue>();
+			return std::make_shared<PatternValue>(
+				value->GetRange(),
+				std::make_shared<nar::PatternAlias>(
+					value->GetRange(),
+					mv[3].IsSkipped() ? nullptr : mv[3].As<T::TypeValue>().GetValue(),
+					mv[2].As<C::IdentifierValue>().GetValue(),
+					mv[0].As<PatternValue>().GetValue()
+				)
+			);
+		}
+
 		inline static std::shared_ptr<IToken> PAlias = Map(
 			All(C::Tokens{PPattern, Exact(C::KwAs, C::PWS), C::PIdentifier, Optional(T::PTypeAnnotation)}, C::PWS),
-			[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				C::Values mv = std::dynamic_pointer_cast<MultiValue>(value)->GetValues();
-				return std::make_shared<PatternValue>(
-					value->GetRange(),
-					std::make_shared<nar::PatternAlias>(
-						value->GetRange(),
-						mv[3]->IsSkipped() ? nullptr : std::dynamic_pointer_cast<T::TypeValue>(mv[3])->GetValue(),
-						std::dynamic_pointer_cast<C::IdentifierValue>(mv[2])->GetValue(),
-						std::dynamic_pointer_cast<PatternValue>(mv[0])->GetValue()
-					)
-				);
-			}
+			MapAlias
 		);
 
-		inline static std::shared_ptr<IToken> PAny = Map(
-			Exact(C::SeqPatternAny, C::PWS),
-			[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				return std::make_shared<PatternValue>(
+		inline static std::shared_ptr<ITokenValue> MapAny(std::shared_ptr<ITokenValue> const& value) {
+			return std::make_shared<PatternValue>(
+				value->GetRange(),
+				std::make_shared<nar::PatternAny>(value->GetRange(), nullptr)
+			);
+		}
+
+		inline static std::shared_ptr<IToken> PAny = Map(Exact(C::SeqPatternAny, C::PWS), MapAny);
+
+		inline static std::shared_ptr<ITokenValue> MapCons(std::shared_ptr<ITokenValue> const& value) {
+			MultiValue const& mv = value->As<MultiValue>();
+			return std::make_shared<PatternValue>(
+				value->GetRange(),
+				std::make_shared<nar::PatternCons>(
 					value->GetRange(),
-					std::make_shared<nar::PatternAny>(value->GetRange(), nullptr)
-				);
-			}
-		);
+					mv[3].IsSkipped() ? nullptr : mv[3].As<T::TypeValue>().GetValue(),
+					mv[0].As<PatternValue>().GetValue(),
+					mv[2].As<PatternValue>().GetValue()
+				)
+			);
+		}
 
 		inline static std::shared_ptr<IToken> PCons = Map(
 			All(C::Tokens{PPattern, Exact(C::SeqCons, C::PWS), PPattern, Optional(T::PTypeAnnotation)}, C::PWS),
-			[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				C::Values mv = std::dynamic_pointer_cast<MultiValue>(value)->GetValues();
-				return std::make_shared<PatternValue>(
-					value->GetRange(),
-					std::make_shared<nar::PatternCons>(
-						value->GetRange(),
-						mv[3]->IsSkipped() ? nullptr : std::dynamic_pointer_cast<T::TypeValue>(mv[3])->GetValue(),
-						std::dynamic_pointer_cast<PatternValue>(mv[0])->GetValue(),
-						std::dynamic_pointer_cast<PatternValue>(mv[2])->GetValue()
-					)
-				);
-			}
+			MapCons
 		);
 
+		inline static std::shared_ptr<ITokenValue> MapConst(std::shared_ptr<ITokenValue> const& value) {
+			MultiValue const& mv = value->As<MultiValue>();
+			return std::make_shared<PatternValue>(
+				value->GetRange(),
+				std::make_shared<nar::PatternConst>(
+					value->GetRange(),
+					mv[1].IsSkipped() ? nullptr : mv[1].As<T::TypeValue>().GetValue(),
+					mv[0].As<C::ConstValue>().GetValue()
+				)
+			);
+		}
+
 		inline static std::shared_ptr<IToken> PConst = Map(
 			All(C::Tokens{C::PConst, Optional(T::PTypeAnnotation)}, C::PWS),
-			[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				C::Values mv = std::dynamic_pointer_cast<MultiValue>(value)->GetValues();
-				return std::make_shared<PatternValue>(
-					value->GetRange(),
-					std::make_shared<nar::PatternConst>(
-						value->GetRange(),
-						mv[1]->IsSkipped() ? nullptr : std::dynamic_pointer_cast<T::TypeValue>(mv[1])->GetValue(),
-						std::dynamic_pointer_cast<C::ConstValue>(mv[0])->GetValue()
-					)
-				);
-			}
+			MapConst
 		);
 
+		inline static std::shared_ptr<ITokenValue> MapNamed(std::shared_ptr<ITokenValue> const& value) {
+			MultiValue const& mv = value->As<MultiValue>();
+			return std::make_shared<PatternValue>(
+				value->GetRange(),
+				std::make_shared<nar::PatternNamed>(
+					value->GetRange(),
+					mv[1].IsSkipped() ? nullptr : mv[1].As<T::TypeValue>().GetValue(),
+					mv[0].As<C::IdentifierValue>().GetValue()
+				)
+			);
+		}
+
 		inline static std::shared_ptr<IToken> PNamed = Map(
 			All(C::Tokens{C::PIdentifier, Optional(T::PTypeAnnotation)}, C::PWS),
-			[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				C::Values mv = std::dynamic_pointer_cast<MultiValue>(value)->GetValues();
-				return std::make_shared<PatternValue>(
-					value->GetRange(),
-					std::make_shared<nar::PatternNamed>(
-						value->GetRange(),
-						mv[1]->IsSkipped() ? nullptr : std::dynamic_pointer_cast<T::TypeValue>(mv[1])->GetValue(),
-						std::dynamic_pointer_cast<C::IdentifierValue>(mv[0])->GetValue()
-					)
-				);
-			}
+			MapNamed
 		);
 
+		inline static std::shared_ptr<ITokenValue> MapDataConstructor(std::shared_ptr<ITokenValue> const& value) {
+			MultiValue const& mv = value->As<MultiValue>();
+			return std::make_shared<PatternValue>(
+				value->GetRange(),
+				std::make_shared<nar::PatternDataConstructor>(
+					value->GetRange(),
+					mv[2].IsSkipped() ? nullptr : mv[2].As<T::TypeValue>().GetValue(),
+					mv[0].As<C::IdentifierValue>().GetValue(),
+					mv[0].GetRange(),
+					mv[1].As<MultiValue>().Extract<std::shared_ptr<IPattern>>()
+				)
+			);
+		}
+
 		inline static std::shared_ptr<IToken> PDataConstructor = Map(
 			All(
 				C::Tokens{
@@ -115,21 +136,21 @@ namespace funcc::nar {
 				},
 				C::PWS
 			),
-			[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				C::Values mv = std::dynamic_pointer_cast<MultiValue>(value)->GetValues();
-				return std::make_shared<PatternValue>(
-					value->GetRange(),
-					std::make_shared<nar::PatternDataConstructor>(
-						value->GetRange(),
-						mv[2]->IsSkipped() ? nullptr : std::dynamic_pointer_cast<T::TypeValue>(mv[2])->GetValue(),
-						std::dynamic_pointer_cast<C::IdentifierValue>(mv[0])->GetValue(),
-						mv[0]->GetRange(),
-						std::dynamic_pointer_cast<MultiValue>(mv[1])->Extract<std::shared_ptr<IPattern>>()
-					)
-				);
-			}
+			MapDataConstructor
 		);
 
+		inline static std::shared_ptr<ITokenValue> MapList(std::shared_ptr<ITokenValue> const& value) {
+			MultiValue const& mv = value->As<MultiValue>();
+			return std::make_shared<PatternValue>(
+				value->GetRange(),
+				std::make_shared<nar::PatternList>(
+					value->GetRange(),
+					mv[1].IsSkipped() ? nullptr : mv[1].As<T::TypeValue>().GetValue(),
+					mv[0].As<MultiValue>().Extract<std::shared_ptr<IPattern>>()
+				)
+			);
+		}
+
 		inline static std::shared_ptr<IToken> PList = Map(
 			All(
 				C::Tokens{
@@ -146,18 +167,27 @@ namespace funcc::nar {
 				},
 				C::PWS
 			),
-			[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				C::Values mv = std::dynamic_pointer_cast<MultiValue>(value)->GetValues();
-				return std::make_shared<PatternValue>(
+			MapList
+		);
+
+		inline static std::shared_ptr<ITokenValue> MapRecord(std::shared_ptr<ITokenValue> const& value) {
+			MultiValue const& mv = value->As<MultiValue>();
+			return std::make_shared<PatternValue>(
+				value->GetRange(),
+				std::make_shared<nar::PatternRecord>(
 					value->GetRange(),
-					std::make_shared<nar::PatternList>(
-						value->GetRange(),
-						mv[1]->IsSkipped() ? nullptr : std::dynamic_pointer_cast<T::TypeValue>(mv[1])->GetValue(),
-						std::dynamic_pointer_cast<MultiValue>(mv[0])->Extract<std::shared_ptr<IPattern>>()
+					mv[1].IsSkipped() ? nullptr : mv[1].As<T::TypeValue>().GetValue(),
+					mv[0].As<MultiValue>().Extract<std::pair<SourceRange, Identifier>>(
+						[](ITokenValue const& item) -> std::pair<SourceRange, Identifier> {
+							return std::make_pair(
+								item.GetRange(),
+								item.As<C::IdentifierValue>().GetValue()
+							);
+						}
 					)
-				);
-			}
-		);
+				)
+			);
+		}
 
 		inline static std::shared_ptr<IToken> PRecord = Map(
 			All(
@@ -173,26 +203,21 @@ namespace funcc::nar {
 				},
 				C::PWS
 			),
-			[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				C::Values mv = std::dynamic_pointer_cast<MultiValue>(value)->GetValues();
-				return std::make_shared<PatternValue>(
-					value->GetRange(),
-					std::make_shared<nar::PatternRecord>(
-						value->GetRange(),
-						mv[1]->IsSkipped() ? nullptr : std::dynamic_pointer_cast<T::TypeValue>(mv[1])->GetValue(),
-						std::dynamic_pointer_cast<MultiValue>(mv[0])->Extract<std::pair<Range, Identifier>>(
-							[](std::shared_ptr<ITokenValue> const& value) -> std::pair<Range, Identifier> {
-								return std::make_pair(
-									value->GetRange(),
-									std::dynamic_pointer_cast<C::IdentifierValue>(value)->GetValue()
-								);
-							}
-						)
-					)
-				);
-			}
+			MapRecord
 		);
 
+		inline static std::shared_ptr<ITokenValue> MapTuple(std::shared_ptr<ITokenValue> const& value) {
+			MultiValue const& mv = value->As<MultiValue>();
+			return std::make_shared<PatternValue>(
+				value->GetRange(),
+				std::make_shared<nar::PatternTuple>(
+					value->GetRange(),
+					mv[1].IsSkipped() ? nullptr : mv[1].As<T::TypeValue>().GetValue(),
+					mv[0].As<MultiValue>().Extract<std::shared_ptr<IPattern>>()
+				)
+			);
+		}
+
 		inline static std::shared_ptr<IToken> PTuple = Map(
 			All(
 				C::Tokens{
@@ -207,19 +232,26 @@ namespace funcc::nar {
 				},
 				C::PWS
 			),
-			[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				C::Values mv = std::dynamic_pointer_cast<MultiValue>(value)->GetValues();
-				return std::make_shared<PatternValue>(
-					value->GetRange(),
-					std::make_shared<nar::PatternTuple>(
-						value->GetRange(),
-						mv[1]->IsSkipped() ? nullptr : std::dynamic_pointer_cast<T::TypeValue>(mv[1])->GetValue(),
-						std::dynamic_pointer_cast<MultiValue>(mv[0])->Extract<std::shared_ptr<IPattern>>()
-					)
-				);
-			}
+			MapTuple
 		);
 
+		inline static std::shared_ptr<ITokenValue> MapFunctionSignature(std::shared_ptr<ITokenValue> const& value) {
+			MultiValue const& mv = value->As<MultiValue>();
+			return std::make_shared<FunctionSignatureValue>(
+				value->GetRange(),
+				FunctionSignature{
+					.range = value->GetRange(),
+					.name = mv[0].As<C::IdentifierValue>().GetValue(),
+					.nameRange = mv[0].GetRange(),
+					.params = mv[1].IsSkipped()
+						? std::vector<std::shared_ptr<IPattern>>{}
+						: mv[1].As<MultiValue>().Extract<std::shared_ptr<IPattern>>(),
+					.returnType =
+						mv[2].IsSkipped() ? nullptr : mv[2].As<T::TypeValue>().GetValue(),
+				}
+			);
+		}
+
 		inline static std::shared_ptr<IToken> PFunctionSignature = Map(
 			All(
 				C::Tokens{
@@ -235,27 +267,14 @@ namespace funcc::nar {
 				},
 				C::PWS
 			),
-			[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				C::Values mv = std::dynamic_pointer_cast<MultiValue>(value)->GetValues();
-				return std::make_shared<FunctionSignatureValue>(
-					value->GetRange(),
-					FunctionSignature{
-						.name = std::dynamic_pointer_cast<C::IdentifierValue>(mv[0])->GetValue(),
-						.nameRange = mv[0]->GetRange(),
-						.params = mv[1]->IsSkipped()
-							? std::vector<std::shared_ptr<IPattern>>{}
-							: std::dynamic_pointer_cast<MultiValue>(mv[1])->Extract<std::shared_ptr<IPattern>>(),
-						.returnType =
-							mv[2]->IsSkipped() ? nullptr : std::dynamic_pointer_cast<T::TypeValue>(mv[2])->GetValue(),
-					}
-				);
-			}
+			MapFunctionSignature
 		);
 
 	private:
 		inline static ForwardDeclarationToken::Replacement PPatternReplacement{
 			PPattern,
-			C::Tokens{PAlias, PAny, PCons, PConst, PNamed, PDataConstructor, PList, PRecord, PTuple}
+			C::Tokens{PAlias, PAny, PCons, PConst, PNamed, PDataConstructor, PList, PRecord, PTuple},
+			C::PWS
 		};
 	};
 }
@@ -15,30 +15,45 @@ namespace funcc::nar {
 
 		inline static std::shared_ptr<IToken> PType = ForwardDeclaration();
 
+		inline static std::shared_ptr<ITokenValue> MapTypeParameter(std::shared_ptr<ITokenValue> const& value) {
+			return std::make_shared<TypeValue>(
+				value->GetRange(),
+				std::make_shared<VarintType>(
+					value->GetRange(),
+					value->As<C::IdentifierValue>().GetValue()
+				)
+			);
+		}
+
 		inline static std::shared_ptr<IToken> PTypeParameters = Some(
-			Map(C::PIdentifier,
-				[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-					return std::make_shared<TypeValue>(
-						value->GetRange(),
-						std::make_shared<VarintType>(
-							value->GetRange(),
-							std::dynamic_pointer_cast<C::IdentifierValue>(value)->GetValue()
-						)
-					);
-				}),
+			Map(C::PIdentifier, MapTypeParameter),
 			Exact(C::SeqTypeParametersOpen, C::PWS),
 			Exact(C::SeqTypeParametersClose, C::PWS),
 			Exact(C::SeqTypeParametersSep, C::PWS),
 			C::PWS
 		);
 
+		inline static std::shared_ptr<ITokenValue> MapTypeAnnotation(std::shared_ptr<ITokenValue> const& value) {
+			return value->As<MultiValue>().GetValues()[1];
+		}
+
 		inline static std::shared_ptr<IToken> PTypeAnnotation = Map(
 			All(C::Tokens{Exact(C::SeqTypeAnnotation, C::PWS), PType}, C::PWS),
-			[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				return std::dynamic_pointer_cast<MultiValue>(value)->GetValues()[1];
-			}
+			MapTypeAnnotation
 		);
 
+		inline static std::shared_ptr<ITokenValue> MapFunctionType(std::shared_ptr<ITokenValue> const& value) {
+			MultiValue const& mv = value->As<MultiValue>();
+			return std::make_shared<TypeValue>(
+				value->GetRange(),
+				std::make_shared<nar::FunctionType>(
+					value->GetRange(),
+					mv[0].As<MultiValue>().Extract<std::shared_ptr<nar::IType>>(),
+					mv[1].As<TypeValue>().GetValue()
+				)
+			);
+		}
+
 		// TODO: support names for funtion parameter types
 		inline static std::shared_ptr<IToken> PFunctionType = Map(
 			All(
@@ -54,52 +69,63 @@ namespace funcc::nar {
 				},
 				C::PWS
 			),
-			[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				std::shared_ptr<MultiValue> mv = std::dynamic_pointer_cast<MultiValue>(value);
-				return std::make_shared<TypeValue>(
-					value->GetRange(),
-					std::make_shared<nar::FunctionType>(
-						value->GetRange(),
-						mv->Extract<std::shared_ptr<nar::IType>>(),
-						std::dynamic_pointer_cast<TypeValue>(mv->GetValues()[1])->GetValue()
-					)
-				);
-			}
+			MapFunctionType
 		);
 
+		inline static std::shared_ptr<ITokenValue> MapNamedType(std::shared_ptr<ITokenValue> const& value) {
+			MultiValue const& mv = value->As<MultiValue>();
+			return std::make_shared<TypeValue>(
+				value->GetRange(),
+				std::make_shared<nar::NamedType>(
+					value->GetRange(),
+					mv[0].As<C::IdentifierValue>().GetValue(),
+					value->GetRange(),
+					mv[1].IsSkipped()
+						? std::vector<std::shared_ptr<IType>>{}
+						: mv[1].As<MultiValue>().Extract<std::shared_ptr<IType>>()
+				)
+			);
+		}
+
 		inline static std::shared_ptr<IToken> PNamedType = Map(
 			All(C::Tokens{C::PIdentifier, Optional(PTypeParameters)}, C::PWS),
-			[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				std::vector<std::shared_ptr<ITokenValue>> mv = std::dynamic_pointer_cast<MultiValue>(value)->GetValues(
-				);
+			MapNamedType
+		);
+
+		inline static std::shared_ptr<ITokenValue> MapVariantType(std::shared_ptr<ITokenValue> const& value) {
+			nar::Identifier id = value->As<C::IdentifierValue>().GetValue();
+			if (std::islower(id.GetText()[0])) {
 				return std::make_shared<TypeValue>(
 					value->GetRange(),
-					std::make_shared<nar::NamedType>(
-						value->GetRange(),
-						std::dynamic_pointer_cast<C::IdentifierValue>(mv[0])->GetValue(),
-						value->GetRange(),
-						mv[1]->IsSkipped()
-							? std::vector<std::shared_ptr<IType>>{}
-							: std::dynamic_pointer_cast<MultiValue>(mv[1])->Extract<std::shared_ptr<IType>>()
-					)
+					std::make_shared<VarintType>(value->GetRange(), id)
 				);
 			}
-		);
+			return std::make_shared<ErrorValue>(
+				value->GetRange(),
+				"Expected lowercase identifier for variable type"
+			);
+		}
 
-		inline static std::shared_ptr<IToken> PVariantType =
-			Map(C::PIdentifier, [](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				nar::Identifier id = std::dynamic_pointer_cast<C::IdentifierValue>(value)->GetValue();
-				if (std::islower(id[0])) {
-					return std::make_shared<TypeValue>(
-						value->GetRange(),
-						std::make_shared<VarintType>(value->GetRange(), id)
-					);
-				}
-				return std::make_shared<ErrorValue>(
+		inline static std::shared_ptr<IToken> PVariantType = Map(C::PIdentifier, MapVariantType);
+
+		inline static std::shared_ptr<ITokenValue> MapRecordType(std::shared_ptr<ITokenValue> const& value) {
+			return std::make_shared<TypeValue>(
+				value->GetRange(),
+				std::make_shared<nar::RecordType>(
 					value->GetRange(),
-					"Expected lowercase identifier for variable type"
-				);
-			});
+					value->As<MultiValue>().Extract<RecordField>(
+						[](ITokenValue const& item) -> RecordField {
+							MultiValue const& mv = item.As<MultiValue>();
+							return RecordField{
+								.name = mv[0].As<C::IdentifierValue>().GetValue(),
+								.nameRange = mv[0].GetRange(),
+								.type = mv[1].As<TypeValue>().GetValue(),
+							};
+						}
+					)
+				)
+			);
+		}
 
 		inline static std::shared_ptr<IToken> PRecordType = Map(
 			Some(
@@ -109,27 +135,19 @@ namespace funcc::nar {
 				Exact(C::SeqRecordSep, C::PWS),
 				C::PWS
 			),
-			[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				return std::make_shared<TypeValue>(
-					value->GetRange(),
-					std::make_shared<nar::RecordType>(
-						value->GetRange(),
-						std::dynamic_pointer_cast<MultiValue>(value)->Extract<RecordField>(
-							[](std::shared_ptr<ITokenValue> const& value) -> RecordField {
-								std::vector<std::shared_ptr<ITokenValue>> mv =
-									std::dynamic_pointer_cast<MultiValue>(value)->GetValues();
-								return RecordField{
-									.name = std::dynamic_pointer_cast<C::IdentifierValue>(mv[0])->GetValue(),
-									.nameRange = mv[0]->GetRange(),
-									.type = std::dynamic_pointer_cast<TypeValue>(mv[1])->GetValue(),
-								};
-							}
-						)
-					)
-				);
-			}
+			MapRecordType
 		);
 
+		inline static std::shared_ptr<ITokenValue> MapTupleType(std::shared_ptr<ITokenValue> const& value) {
+			return std::make_shared<TypeValue>(
+				value->GetRange(),
+				std::make_shared<nar::TupleType>(
+					value->GetRange(),
+					value->As<MultiValue>().Extract<std::shared_ptr<nar::IType>>()
+				)
+			);
+		}
+
 		inline static std::shared_ptr<IToken> PTupleType = Map(
 			Some(
 				PType,
@@ -138,31 +156,23 @@ namespace funcc::nar {
 				Exact(C::SeqTupleSep, C::PWS),
 				C::PWS
 			),
-			[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				return std::make_shared<TypeValue>(
-					value->GetRange(),
-					std::make_shared<nar::TupleType>(
-						value->GetRange(),
-						std::dynamic_pointer_cast<MultiValue>(value)->Extract<std::shared_ptr<nar::IType>>()
-					)
-				);
-			}
+			MapTupleType
 		);
 
-		inline static std::shared_ptr<IToken> PUnitType = Map(
-			Exact(C::SeqUnitType, C::PWS),
-			[](std::shared_ptr<ITokenValue> const& value) -> std::shared_ptr<ITokenValue> {
-				return std::make_shared<TypeValue>(
-					value->GetRange(),
-					std::make_shared<nar::UnitType>(value->GetRange())
-				);
-			}
-		);
+		inline static std::shared_ptr<ITokenValue> MapUnitType(std::shared_ptr<ITokenValue> const& value) {
+			return std::make_shared<TypeValue>(
+				value->GetRange(),
+				std::make_shared<nar::UnitType>(value->GetRange())
+			);
+		}
+
+		inline static std::shared_ptr<IToken> PUnitType = Map(Exact(C::SeqUnitType, C::PWS), MapUnitType);
 
 	private:
 		inline static ForwardDeclarationToken::Replacement PTypeReplacement{
 			PType,
-			C::Tokens{PFunctionType, PNamedType, PVariantType, PRecordType, PTupleType, PUnitType}
+			C::Tokens{PFunctionType, PNamedType, PVariantType, PRecordType, PTupleType, PUnitType},
+			C::PWS
 		};
 	};
 }
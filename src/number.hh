@@ -0,0 +1,147 @@
+#pragma once
+
+#include "_external.hh"
+
+namespace funcc {
+	// A numeric literal scanned from the start of a text in one pass: an optional sign, then a hexadecimal (0x) or
+	// binary (0b) integer, or a decimal with optional fraction and exponent. Digits may be separated by single '_'.
+	// Nothing past the text is read and the locale does not matter.
+	struct Number {
+		constexpr static size_t NoMatch = SIZE_MAX;
+
+		// bytes the literal takes, NoMatch when the text does not start with one
+		size_t length{NoMatch};
+		// the literal is well formed but its value does not fit an int64_t or a double, the value is left 0
+		bool outOfRange{false};
+		// without a fraction or an exponent
+		bool isInteger{false};
+		int64_t integer{0};
+		double real{0};
+
+		[[nodiscard]] static Number Scan(std::string_view text) {
+			size_t i = 0;
+			bool negative = false;
+			if (i < text.size() && (text[i] == '+' || text[i] == '-')) {
+				negative = text[i] == '-';
+				i++;
+			}
+
+			bool separated = false;
+			for (int base: {16, 2}) {
+				char prefix = base == 16 ? 'x' : 'b';
+				if (i + 2 < text.size() && text[i] == '0' && (text[i + 1] | 0x20) == prefix &&
+					IsDigit(text[i + 2], base)) {
+					size_t start = i + 2;
+					size_t end = start + Digits(text.substr(start), base, separated);
+					return Integer(Strip(text.substr(start, end - start), separated), base, negative, end);
+				}
+			}
+
+			size_t start = i;
+			size_t mantissa = Digits(text.substr(i), 10, separated);
+			i += mantissa;
+			bool isInteger = true;
+			if (i < text.size() && text[i] == '.') {
+				size_t fraction = Digits(text.substr(i + 1), 10, separated);
+				if (mantissa == 0 && fraction == 0) {
+					return Number{};
+				}
+				i += 1 + fraction;
+				isInteger = false;
+			} else if (mantissa == 0) {
+				return Number{};
+			}
+			if (i < text.size() && (text[i] | 0x20) == 'e') {
+				size_t exponent = i + 1;
+				if (exponent < text.size() && (text[exponent] == '+' || text[exponent] == '-')) {
+					exponent++;
+				}
+				bool ignored = false;
+				if (size_t digits = Digits(text.substr(exponent), 10, ignored); digits > 0 && !ignored) {
+					i = exponent + digits;
+					isInteger = false;
+				}
+			}
+
+			std::string_view literal = Strip(text.substr(start, i - start), separated);
+			if (isInteger) {
+				return Integer(literal, 10, negative, i);
+			}
+			double value = 0;
+			auto [end, error] = std::from_chars(literal.data(), literal.data() + literal.size(), value);
+			if ((error != std::errc{} && error != std::errc::result_out_of_range) ||
+				end != literal.data() + literal.size()) {
+				return Number{};
+			}
+			Number number{};
+			number.length = i;
+			number.outOfRange = error == std::errc::result_out_of_range;
+			number.real = number.outOfRange ? 0 : negative ? -value : value;
+			return number;
+		}
+
+	private:
+		static bool IsDigit(char c, int base) {
+			switch (base) {
+				case 2:
+					return c == '0' || c == '1';
+				case 16:
+					return (c >= '0' && c <= '9') || ((c | 0x20) >= 'a' && (c | 0x20) <= 'f');
+				default:
+					return c >= '0' && c <= '9';
+			}
+		}
+
+		// Length of the run of digits at the start of text. A separator belongs to the run when digits surround it,
+		// outSeparated is set if one does.
+		static size_t Digits(std::string_view text, int base, bool& outSeparated) {
+			size_t i = 0;
+			while (i < text.size()) {
+				if (IsDigit(text[i], base)) {
+					i++;
+				} else if (text[i] == '_' && i > 0 && i + 1 < text.size() && IsDigit(text[i + 1], base)) {
+					outSeparated = true;
+					i++;
+				} else {
+					break;
+				}
+			}
+			return i;
+		}
+
+		// from_chars knows no separators, the literal is copied without them only if it has any
+		static std::string_view Strip(std::string_view literal, bool separated) {
+			thread_local std::string stripped{};
+			if (!separated) {
+				return literal;
+			}
+			stripped.clear();
+			for (char c: literal) {
+				if (c != '_') {
+					stripped += c;
+				}
+			}
+			return stripped;
+		}
+
+		static Number Integer(std::string_view digits, int base, bool negative, size_t length) {
+			uint64_t magnitude = 0;
+			auto [end, error] = std::from_chars(digits.data(), digits.data() + digits.size(), magnitude, base);
+			if ((error != std::errc{} && error != std::errc::result_out_of_range) ||
+				end != digits.data() + digits.size()) {
+				return Number{};
+			}
+			Number number{};
+			number.length = length;
+			number.isInteger = true;
+			uint64_t limit = negative ? uint64_t{1} << 63 : static_cast<uint64_t>(INT64_MAX);
+			if (error == std::errc::result_out_of_range || magnitude > limit) {
+				number.outOfRange = true;
+				return number;
+			}
+			number.integer = static_cast<int64_t>(negative ? 0 - magnitude : magnitude);
+			number.real = static_cast<double>(number.integer);
+			return number;
+		}
+	};
+}
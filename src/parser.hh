@@ -1,12 +1,16 @@
 #pragma once
 
 #include "_external.hh"
+#include "arena.hh"
 #include "ast_common.hh"
+#include "number.hh"
 #include "reader.hh"
+#include "scan.hh"
+#include "token_stream.hh"
 
-#define skipWs()                     \
-	if (m_ignoreWS) {                \
-		m_ignoreWS->Consume(reader); \
+#define skipWs()                                  \
+	if (m_ignoreWS) {                             \
+		SkipTrivia(*m_ignoreWS, reader, context); \
 	}
 
 #define FUNCC_DEBUG_TOKEN ""
@@ -62,6 +66,13 @@ namespace funcc::parser {
 		[[nodiscard]] Range const& GetRange() const {
 			return m_range;
 		}
+
+		// the value as the type its token is known to produce, mappers rely on the grammar and only debug builds check
+		template<typename V>
+		[[nodiscard]] V const& As() const {
+			assert(dynamic_cast<V const*>(this) != nullptr);
+			return static_cast<V const&>(*this);
+		}
 	};
 
 	class ErrorValue : public ITokenValue {
@@ -103,6 +114,39 @@ namespace funcc::parser {
 		}
 	};
 
+	// what a set of literals matched, the index is the position of the literal in the set
+	class LiteralValue : public SimpleValue {
+		size_t m_index;
+
+	public:
+		LiteralValue(size_t index, Location start, IReader& reader) :
+			SimpleValue{ValueKind::Exact, std::move(start), reader},
+			m_index{index} {}
+
+		~LiteralValue() = default;
+
+		[[nodiscard]] size_t GetIndex() const {
+			return m_index;
+		}
+	};
+
+	// what a word token matched, with the symbol the lexer interned for it if the word is a whole lexeme
+	class WordValue : public SimpleValue {
+		Symbol m_symbol;
+
+	public:
+		WordValue(Location start, IReader& reader, Symbol symbol) :
+			SimpleValue{ValueKind::Entity, std::move(start), reader},
+			m_symbol{symbol} {}
+
+		~WordValue() = default;
+
+		// interns the text only if the lexer did not
+		[[nodiscard]] Symbol GetSymbol() const {
+			return m_symbol.IsEmpty() ? Symbol::Intern(GetValue()) : m_symbol;
+		}
+	};
+
 	template<typename T>
 	class Value : public ITokenValue {
 		T m_value{};
@@ -124,40 +168,29 @@ namespace funcc::parser {
 	};
 
 	class NumberLiteralValue : public ITokenValue {
-		bool m_isInteger;
-		int64_t m_integer;
-		bool m_isFloat;
-		double m_float;
+		Number m_number;
 
 	public:
-		NumberLiteralValue(Location start, IReader& reader) :
-			ITokenValue{ValueKind::NumberLiteral, Range{std::move(start), reader.GetLocation()}} {
-			std::string_view std = reader.Sub(GetRange());
-
-			char* endPtr = nullptr;
-			m_float = strtod(std.data(), &endPtr);
-			m_isFloat = endPtr == std.data() + std.length();
-
-			m_integer = strtoll(std.data(), &endPtr, 10);
-			m_isInteger = endPtr == std.data() + std.length();
-		}
+		NumberLiteralValue(Location start, IReader& reader, Number const& number) :
+			ITokenValue{ValueKind::NumberLiteral, Range{std::move(start), reader.GetLocation()}},
+			m_number{number} {}
 
 		~NumberLiteralValue() = default;
 
 		[[nodiscard]] bool IsInteger() const {
-			return m_isInteger;
+			return m_number.isInteger;
 		}
 
 		[[nodiscard]] int64_t GetInteger() const {
-			return m_integer;
+			return m_number.integer;
 		}
 
 		[[nodiscard]] bool IsFloat() const {
-			return m_isFloat;
+			return !m_number.isInteger;
 		}
 
 		[[nodiscard]] double GetFloat() const {
-			return m_float;
+			return m_number.real;
 		}
 	};
 
@@ -175,36 +208,705 @@ namespace funcc::parser {
 			return m_values;
 		}
 
+		[[nodiscard]] size_t GetSize() const {
+			return m_values.size();
+		}
+
+		[[nodiscard]] ITokenValue const& operator[](size_t index) const {
+			return *m_values[index];
+		}
+
+		// what the item at the index holds, the item must be a Value<T>
+		template<typename T>
+		[[nodiscard]] T const& Get(size_t index) const {
+			return m_values[index]->As<Value<T>>().GetValue();
+		}
+
 		template<typename T>
 		[[nodiscard]] std::vector<T> Extract() const {
-			return Extract<T>([](std::shared_ptr<ITokenValue> const& value) {
-				return std::dynamic_pointer_cast<Value<T>>(value)->GetValue();
+			return Extract<T>([](ITokenValue const& value) {
+				return value.As<Value<T>>().GetValue();
 			});
 		}
 
-		template<typename T>
-		[[nodiscard]] std::vector<T> Extract(std::function<T(std::shared_ptr<ITokenValue> const&)> extractor) const {
+		template<typename T, typename F>
+		[[nodiscard]] std::vector<T> Extract(F&& extractor) const {
 			std::vector<T> result{};
+			result.reserve(m_values.size());
 			for (auto& value: m_values) {
-				result.push_back(extractor(value));
+				result.push_back(extractor(*value));
 			}
 			return result;
 		}
 	};
 
+	struct MemoStats {
+		size_t hits{0};
+		size_t misses{0};
+		size_t evictions{0};
+	};
+
+	class MemoTable {
+	public:
+		struct Entry {
+			// the token or fixed grammar node that produced the result
+			void const* key;
+			std::shared_ptr<ITokenValue> result;
+			Location end;
+			// set while a forward declaration is still computing this entry, such entries are never evicted
+			bool pending{false};
+			// set when the pending entry was requested again at the same position (left recursion)
+			bool leftRecursive{false};
+		};
+
+		constexpr static size_t DefaultCapacity = 1 << 18;
+
+	private:
+		std::unordered_map<size_t, std::vector<Entry>> m_entries{};
+		std::deque<size_t> m_positions{};
+		size_t m_size{0};
+		size_t m_capacity;
+		MemoStats m_stats{};
+
+	public:
+		explicit MemoTable(size_t capacity = DefaultCapacity) :
+			m_capacity{capacity} {}
+
+		~MemoTable() = default;
+
+		[[nodiscard]] Entry* Find(void const* key, size_t position) {
+			Entry* entry = Lookup(key, position);
+			if (entry) {
+				m_stats.hits++;
+			} else {
+				m_stats.misses++;
+			}
+			return entry;
+		}
+
+		// same as Find, but does not count towards the statistics
+		[[nodiscard]] Entry* Lookup(void const* key, size_t position) {
+			auto it = m_entries.find(position);
+			if (it != m_entries.end()) {
+				for (auto& entry: it->second) {
+					if (entry.key == key) {
+						return &entry;
+					}
+				}
+			}
+			return nullptr;
+		}
+
+		// with no capacity only pending entries are kept, storing a finished result drops the entry
+		void Store(
+			void const* key,
+			size_t position,
+			std::shared_ptr<ITokenValue> result,
+			Location end,
+			bool pending = false
+		) {
+			if (m_capacity == 0 && !pending) {
+				Erase(key, position);
+				return;
+			}
+			Evict();
+
+			auto [it, inserted] = m_entries.try_emplace(position);
+			if (inserted) {
+				m_positions.push_back(position);
+			}
+
+			for (auto& entry: it->second) {
+				if (entry.key == key) {
+					entry.result = std::move(result);
+					entry.end = std::move(end);
+					entry.pending = pending;
+					return;
+				}
+			}
+			it->second.push_back(Entry{key, std::move(result), std::move(end), pending});
+			m_size++;
+		}
+
+		// drops all finished entries at the position, they may depend on a left recursive seed that has grown since
+		void Invalidate(size_t position) {
+			auto it = m_entries.find(position);
+			if (it == m_entries.end()) {
+				return;
+			}
+			std::vector<Entry>& bucket = it->second;
+			size_t size = bucket.size();
+			bucket.erase(
+				std::remove_if(bucket.begin(), bucket.end(), [](Entry const& entry) { return !entry.pending; }),
+				bucket.end()
+			);
+			m_size -= size - bucket.size();
+		}
+
+		[[nodiscard]] MemoStats const& GetStats() const {
+			return m_stats;
+		}
+
+	private:
+		void Erase(void const* key, size_t position) {
+			auto it = m_entries.find(position);
+			if (it == m_entries.end()) {
+				return;
+			}
+			std::vector<Entry>& bucket = it->second;
+			auto entry = std::find_if(bucket.begin(), bucket.end(), [key](Entry const& e) { return e.key == key; });
+			if (entry != bucket.end()) {
+				bucket.erase(entry);
+				m_size--;
+			}
+		}
+
+		void Evict() {
+			// parsing moves forward, so the oldest positions are the least likely to be visited again
+			size_t attempts = m_positions.size();
+			while (m_size >= m_capacity && attempts-- > 0) {
+				size_t position = m_positions.front();
+				m_positions.pop_front();
+
+				auto it = m_entries.find(position);
+				std::vector<Entry>& bucket = it->second;
+				if (std::any_of(bucket.begin(), bucket.end(), [](Entry const& entry) { return entry.pending; })) {
+					m_positions.push_back(position);
+					continue;
+				}
+				m_size -= bucket.size();
+				m_stats.evictions += bucket.size();
+				m_entries.erase(it);
+			}
+		}
+	};
+
+	// Characters a token can start with once its leading trivia is skipped. Code points from 0xFF up share the last
+	// slot.
+	struct FirstSet {
+		std::bitset<256> chars{};
+		// the token can succeed without consuming anything, so whatever follows it can start the match as well
+		bool nullable{false};
+
+		[[nodiscard]] static size_t Slot(uint32_t c) {
+			return c < 0xFF ? c : 0xFF;
+		}
+
+		// Forward declarations cache their sets in place and are shared by every grammar user, sets are collected
+		// under this lock.
+		[[nodiscard]] static std::mutex& GetCollectMutex() {
+			static std::mutex mutex{};
+			return mutex;
+		}
+
+		[[nodiscard]] static FirstSet Any() {
+			FirstSet any{};
+			any.chars.set();
+			any.nullable = true;
+			return any;
+		}
+
+		[[nodiscard]] static FirstSet Of(std::string_view chars) {
+			FirstSet first{};
+			for (char c: chars) {
+				auto byte = static_cast<unsigned char>(c);
+				if (byte < 0x80) {
+					first.chars.set(byte);
+				} else {
+					// the reader yields decoded code points, any of them can come from a multibyte sequence
+					for (size_t slot = 0x80; slot < 0x100; ++slot) {
+						first.chars.set(slot);
+					}
+				}
+			}
+			return first;
+		}
+
+		FirstSet operator|(FirstSet const& other) const {
+			FirstSet first{};
+			first.chars = chars | other.chars;
+			first.nullable = nullable || other.nullable;
+			return first;
+		}
+	};
+
+	// What a token expected when it failed. Messages are only built for the failure that gets reported.
+	enum class FailureKind : uint8_t {
+		None,
+		Exact,
+		WhiteSpace,
+		Identifier,
+		Number,
+		NumberOutOfRange,
+		EndOfFile,
+		// expected lists every literal of a set
+		Literals,
+		UnexpectedCharacter,
+		RecursionLimit,
+		// a mapper rejected what the token matched, its error value holds the message
+		Mapped
+	};
+
+	struct Failure {
+		Location location{0};
+		FailureKind kind{FailureKind::None};
+		// literal an exact match expected
+		std::string_view expected{};
+	};
+
+	// Keeps the failure that got furthest into the input, it is the one worth reporting when the parse fails.
+	// Backtracking makes tokens fail all the time, so recording one is a comparison and a copy.
+	class FailureTracker {
+		Failure m_furthest{};
+		std::shared_ptr<ITokenValue> m_mapped{};
+		Failure m_fatal{};
+
+	public:
+		FailureTracker() = default;
+
+		~FailureTracker() = default;
+
+		void Record(Location location, FailureKind kind, std::string_view expected = {}) {
+			if (IsBehind(location)) {
+				return;
+			}
+			m_furthest = Failure{location, kind, expected};
+			m_mapped.reset();
+		}
+
+		void RecordMapped(std::shared_ptr<ITokenValue> error) {
+			if (IsBehind(error->GetRange().start)) {
+				return;
+			}
+			m_furthest = Failure{error->GetRange().start, FailureKind::Mapped};
+			m_mapped = std::move(error);
+		}
+
+		// a failure no other alternative may recover from, the parse fails with the first one even if it matches
+		void RecordFatal(Location location, FailureKind kind) {
+			if (m_fatal.kind == FailureKind::None) {
+				m_fatal = Failure{location, kind};
+			}
+		}
+
+		[[nodiscard]] bool HasFatal() const {
+			return m_fatal.kind != FailureKind::None;
+		}
+
+		[[nodiscard]] Failure const& GetFurthest() const {
+			return m_furthest;
+		}
+
+		// error value describing the fatal or else the furthest failure, on the heap so it outlives the parse
+		[[nodiscard]] std::shared_ptr<ITokenValue> MakeError() const {
+			if (HasFatal()) {
+				return std::make_shared<ErrorValue>(Range{m_fatal.location, m_fatal.location}, Describe(m_fatal));
+			}
+			if (m_furthest.kind == FailureKind::Mapped) {
+				auto error = std::static_pointer_cast<ErrorValue>(m_mapped);
+				return std::make_shared<ErrorValue>(error->GetRange(), std::string(error->GetMessage()));
+			}
+			if (m_furthest.kind == FailureKind::None) {
+				return std::make_shared<ErrorValue>("Unexpected input");
+			}
+			return std::make_shared<ErrorValue>(Range{m_furthest.location, m_furthest.location}, Describe(m_furthest));
+		}
+
+	private:
+		// the first failure at a position wins
+		[[nodiscard]] bool IsBehind(Location const& location) const {
+			return m_furthest.kind != FailureKind::None && !(m_furthest.location < location);
+		}
+
+		[[nodiscard]] static std::string Describe(Failure const& failure) {
+			switch (failure.kind) {
+				case FailureKind::Exact:
+					// TODO: make it better?
+					return std::string("Expected '") + std::string(failure.expected) + std::string("'");
+				case FailureKind::WhiteSpace:
+					return "Expected whitespace";
+				case FailureKind::Identifier:
+					return "Invalid identifier";
+				case FailureKind::Number:
+					return "Expected number";
+				case FailureKind::NumberOutOfRange:
+					return "Number out of range";
+				case FailureKind::Literals:
+					return std::string("Expected ") + std::string(failure.expected);
+				case FailureKind::EndOfFile:
+					return "Expected end of file";
+				case FailureKind::UnexpectedCharacter:
+					return "Unexpected character";
+				case FailureKind::RecursionLimit:
+					return "Forward declaration recursion limit exceeded";
+				default:
+					return "Unexpected input";
+			}
+		}
+	};
+
+	// Everything a parse changes. The grammar is built once and shared by all parses, possibly on several threads at
+	// once, so tokens keep their per-parse state here instead of in members.
+	class ParseContext {
+		TokenStream const* m_tokens;
+		// declared before everything that can hold results allocated from it
+		Arena m_arena{};
+		MemoTable m_memoTable;
+		FailureTracker m_failures{};
+		// recursion depth of every forward declaration, indexed by its slot
+		std::vector<int> m_depths{};
+
+		inline static std::atomic<size_t> DepthSlots{0};
+
+	public:
+		// Lexemes let tokens skip trivia and lexemes without scanning them. A zero memo capacity disables packrat
+		// memoization, the table then only holds what left recursive rules need.
+		explicit ParseContext(TokenStream const* tokens = nullptr, size_t memoCapacity = 0) :
+			m_tokens{tokens},
+			m_memoTable{memoCapacity} {}
+
+		ParseContext(ParseContext const&) = delete;
+		ParseContext& operator=(ParseContext const&) = delete;
+
+		~ParseContext() = default;
+
+		[[nodiscard]] TokenStream const* GetTokenStream() const {
+			return m_tokens;
+		}
+
+		[[nodiscard]] Arena& GetArena() {
+			return m_arena;
+		}
+
+		[[nodiscard]] MemoTable& GetMemoTable() {
+			return m_memoTable;
+		}
+
+		[[nodiscard]] MemoStats GetMemoStats() const {
+			return m_memoTable.GetStats();
+		}
+
+		[[nodiscard]] FailureTracker& GetFailures() {
+			return m_failures;
+		}
+
+		// slot for the recursion depth of a new forward declaration or rule
+		[[nodiscard]] static size_t NewDepthSlot() {
+			return DepthSlots++;
+		}
+
+		[[nodiscard]] int& GetDepth(size_t slot) {
+			if (slot >= m_depths.size()) {
+				m_depths.resize(slot + 1, 0);
+			}
+			return m_depths[slot];
+		}
+	};
+
+	class ProgramBuilder;
+
 	class IToken {
 	public:
+		// returned by every failed attempt, what failed is recorded by the FailureTracker of the context
+		inline static std::shared_ptr<ITokenValue> const Failed = std::make_shared<ErrorValue>();
+
 		virtual ~IToken() = default;
-		virtual std::shared_ptr<ITokenValue> Consume(IReader& reader) const = 0;
+		virtual std::shared_ptr<ITokenValue> Consume(IReader& reader, ParseContext& context) const = 0;
 
-	protected:
-		std::shared_ptr<ITokenValue> RewindWithError(Location start, IReader& reader, std::string_view message) const {
-			Range range{start, reader.GetLocation()};
+		// Adds the characters this token can start with to `first`. `visiting` holds the forward declarations being
+		// expanded, to stop on recursion. The default allows anything, so unknown tokens are always tried.
+		virtual void CollectFirst(FirstSet& first, [[maybe_unused]] std::vector<void const*>& visiting) const {
+			first = first | FirstSet::Any();
+		}
+
+		// Moves over whatever the token matches without building a value, used for trivia. Returns whether the token
+		// matched; a failed skip leaves the reader where it was.
+		virtual bool Skip(IReader& reader, ParseContext& context) const {
+			return Consume(reader, context)->HasValue();
+		}
+
+		// Emits the instructions matching this token for the parsing machine. The default calls the token as a whole,
+		// which is what leaves do.
+		virtual void Compile(ProgramBuilder& builder) const;
+
+		[[nodiscard]] FirstSet GetFirst() const {
+			std::lock_guard<std::mutex> lock{FirstSet::GetCollectMutex()};
+
+			FirstSet first{};
+			std::vector<void const*> visiting{};
+			CollectFirst(first, visiting);
+			return first;
+		}
+
+		// helpers shared by the tokens and the nodes of the fixed grammar
+
+		// trivia runs the lexer has already seen are jumped over
+		static void SkipTrivia(IToken const& trivia, IReader& reader, ParseContext& context) {
+			TokenStream const* tokens = context.GetTokenStream();
+			if (tokens && tokens->GetTrivia() == &trivia && tokens->SkipTrivia(reader)) {
+				return;
+			}
+			trivia.Skip(reader, context);
+		}
+
+		// records the failure where the reader stopped
+		static std::shared_ptr<ITokenValue> RewindWithError(
+			Location start,
+			IReader& reader,
+			ParseContext& context,
+			FailureKind kind,
+			std::string_view expected = {}
+		) {
+			context.GetFailures().Record(reader.GetLocation(), kind, expected);
 			reader.SetLocation(start);
-			return std::make_shared<ErrorValue>(range, std::string(message));
+			return Failed;
 		}
+
+		// results are dropped on backtracking far more often than they are kept, so they come from the parse arena
+		template<typename T, typename... Args>
+		static std::shared_ptr<T> Make(ParseContext& context, Args&&... args) {
+			return std::allocate_shared<T>(ArenaAllocator<T>{context.GetArena()}, std::forward<Args>(args)...);
+		}
+
+		template<typename F>
+		static std::shared_ptr<ITokenValue> Memoize(
+			void const* key,
+			IReader& reader,
+			ParseContext& context,
+			F&& consume
+		) {
+			MemoTable& memo = context.GetMemoTable();
+			Location start = reader.GetLocation();
+			if (MemoTable::Entry const* entry = memo.Find(key, start.position)) {
+				reader.SetLocation(entry->end);
+				return entry->result;
+			}
+
+			std::shared_ptr<ITokenValue> result = consume();
+			memo.Store(key, start.position, result, reader.GetLocation());
+			return result;
+		}
+
+	protected:
+		// looks the token up in the lexemes of the context, a match moves the reader to its end
+		LexemeMatch MatchLexeme(IReader& reader, ParseContext& context) const {
+			TokenStream const* tokens = context.GetTokenStream();
+			if (!tokens) {
+				return LexemeMatch::Unknown;
+			}
+			Location end{};
+			LexemeMatch match = tokens->Match(this, reader.GetLocation(), end);
+			if (match == LexemeMatch::Matched) {
+				reader.SetLocation(end);
+			}
+			return match;
+		}
+	};
+
+	// Instructions of the parsing machine. Targets are instruction indices, arguments index the tables of the program.
+	enum class Opcode : uint8_t {
+		// go to target
+		Jump,
+		// push a backtrack entry that resumes at target with the current position and values
+		Choice,
+		// drop the backtrack entry of the last choice and go to target
+		Commit,
+		// drop the backtrack entry of the last choice, restore its position and values and go to target
+		BackCommit,
+		// backtrack to the last choice
+		Fail,
+		// enter rule arg, its trivia, memo entry and left recursion included
+		Call,
+		// leave the current rule with the last value
+		Return,
+		// go to target with the memoized result of token arg, or start recording one
+		MemoEnter,
+		// record the last value for the innermost MemoEnter
+		MemoLeave,
+		// the last value is the result
+		End,
+		// go to target unless the current character is in set arg
+		TestSet,
+		// match exact token arg
+		Literal,
+		// match token arg as a whole
+		Token,
+		// skip trivia token arg
+		Trivia,
+		// record an unexpected character and fail
+		Unexpected,
+		// start a value at the current position
+		Open,
+		// close the value of the last Open with the values since, ignored ones left out
+		CaptureAll,
+		// close the value of the last Open with the values since, fail without any when arg is set
+		CaptureList,
+		// replace the last value by what mapper arg makes of it
+		Map,
+		// drop the last value
+		Drop,
+		// push the value of a skipped optional
+		Skipped
+	};
+
+	struct Instruction {
+		Opcode op;
+		uint32_t arg{0};
+		uint32_t target{0};
+	};
+
+	// a grammar compiled for the parsing machine
+	struct Program {
+		using Mapper = std::function<std::shared_ptr<ITokenValue>(std::shared_ptr<ITokenValue> const& value)>;
+
+		// a forward declaration, called by the instructions that use it
+		struct Rule {
+			void const* key;
+			size_t slot;
+			IToken const* trivia;
+			uint32_t body{0};
+		};
+
+		std::vector<Instruction> code{};
+		std::vector<IToken const*> tokens{};
+		std::vector<std::bitset<256>> sets{};
+		std::vector<Mapper const*> mappers{};
+		std::vector<Rule> rules{};
 	};
 
+	// Turns a token graph into a Program. Tokens emit their own instructions through IToken::Compile, forward
+	// declarations become rules compiled once after the entry point.
+	class ProgramBuilder {
+		struct PendingRule {
+			uint32_t rule;
+			std::vector<std::shared_ptr<IToken>> const* alternatives;
+		};
+
+		Program m_program{};
+		std::unordered_map<void const*, uint32_t> m_rules{};
+		std::vector<PendingRule> m_pending{};
+
+	public:
+		// the grammar must be complete, the first sets of its choices are taken
+		[[nodiscard]] static Program Build(IToken const& root) {
+			ProgramBuilder builder{};
+			builder.Compile(root);
+			builder.Emit(Opcode::End);
+
+			// compiling a rule can reach rules not seen before
+			for (size_t i = 0; i < builder.m_pending.size(); ++i) {
+				PendingRule pending = builder.m_pending[i];
+				Program::Rule& rule = builder.m_program.rules[pending.rule];
+				rule.body = builder.Here();
+				builder.CompileAlternatives(*pending.alternatives, rule.trivia != nullptr, true);
+				builder.Emit(Opcode::Return);
+			}
+			return std::move(builder.m_program);
+		}
+
+		[[nodiscard]] uint32_t Here() const {
+			return static_cast<uint32_t>(m_program.code.size());
+		}
+
+		// returns the index of the instruction, for SetTarget
+		size_t Emit(Opcode op, uint32_t arg = 0, uint32_t target = 0) {
+			m_program.code.push_back(Instruction{op, arg, target});
+			return m_program.code.size() - 1;
+		}
+
+		void SetTarget(size_t instruction, uint32_t target) {
+			m_program.code[instruction].target = target;
+		}
+
+		uint32_t AddToken(IToken const* token) {
+			m_program.tokens.push_back(token);
+			return static_cast<uint32_t>(m_program.tokens.size() - 1);
+		}
+
+		uint32_t AddMapper(Program::Mapper const& mapper) {
+			m_program.mappers.push_back(&mapper);
+			return static_cast<uint32_t>(m_program.mappers.size() - 1);
+		}
+
+		void Compile(IToken const& token) {
+			token.Compile(*this);
+		}
+
+		void CompileTrivia(std::shared_ptr<IToken> const& trivia) {
+			if (trivia) {
+				Emit(Opcode::Trivia, AddToken(trivia.get()));
+			}
+		}
+
+		// a forward declaration, its alternatives are compiled with the other rules
+		void CompileCall(
+			void const* key,
+			size_t slot,
+			IToken const* trivia,
+			std::vector<std::shared_ptr<IToken>> const& alternatives
+		) {
+			auto [it, inserted] = m_rules.try_emplace(key, static_cast<uint32_t>(m_program.rules.size()));
+			if (inserted) {
+				m_program.rules.push_back(Program::Rule{key, slot, trivia});
+				m_pending.push_back(PendingRule{it->second, &alternatives});
+			}
+			Emit(Opcode::Call, it->second);
+		}
+
+		// Alternatives tried in order until one matches, with dispatch only the ones that can start with the current
+		// character as in FirstDispatch. A choice records an unexpected character whenever it fails, a rule only when
+		// no alternative can start.
+		void CompileAlternatives(std::vector<std::shared_ptr<IToken>> const& tokens, bool dispatch, bool rule) {
+			std::vector<std::bitset<256>> starts{};
+			std::bitset<256> any{};
+			if (dispatch) {
+				for (auto& token: tokens) {
+					FirstSet first = token->GetFirst();
+					starts.push_back(first.nullable ? FirstSet::Any().chars : first.chars);
+					any |= starts.back();
+				}
+			}
+
+			size_t none = dispatch ? Emit(Opcode::TestSet, AddSet(any)) : 0;
+			std::vector<size_t> matched{};
+			for (size_t i = 0; i < tokens.size(); ++i) {
+				size_t skip = dispatch ? Emit(Opcode::TestSet, AddSet(starts[i])) : 0;
+				size_t choice = Emit(Opcode::Choice);
+				Compile(*tokens[i]);
+				matched.push_back(Emit(Opcode::Commit));
+
+				SetTarget(choice, Here());
+				if (dispatch) {
+					SetTarget(skip, Here());
+				}
+			}
+
+			if (rule) {
+				Emit(Opcode::Fail);
+			}
+			if (dispatch) {
+				SetTarget(none, Here());
+			}
+			if (!rule || dispatch) {
+				Emit(Opcode::Unexpected);
+			}
+
+			for (size_t instruction: matched) {
+				SetTarget(instruction, Here());
+			}
+		}
+
+	private:
+		uint32_t AddSet(std::bitset<256> const& set) {
+			m_program.sets.push_back(set);
+			return static_cast<uint32_t>(m_program.sets.size() - 1);
+		}
+	};
+
+	inline void IToken::Compile(ProgramBuilder& builder) const {
+		builder.Emit(Opcode::Token, builder.AddToken(this));
+	}
+
 	class ExactToken : public IToken {
 		std::string_view m_target;
 		std::shared_ptr<IToken> m_ignoreWS;
@@ -216,32 +918,180 @@ namespace funcc::parser {
 
 		~ExactToken() override = default;
 
-		std::shared_ptr<ITokenValue> Consume(IReader& reader) const override {
+		std::shared_ptr<ITokenValue> Consume(IReader& reader, ParseContext& context) const override {
 			Location start = reader.GetLocation();
 			skipWs();
+			Location tokenStart = reader.GetLocation();
 
-			size_t length = m_target.length();
-			for (size_t i = 0; i < length; ++i) {
-				if (reader.GetChar() != m_target[i] || !reader.Move()) {
-					return RewindWithError(
-						start,
-						reader,
-						std::string("Expected '") + std::string(m_target) + std::string("'")  // TODO: make it better?
-					);
+			if (TokenStream const* tokens = context.GetTokenStream()) {
+				size_t index = tokens->Find(tokenStart.position);
+				if (index != TokenStream::NotFound && tokens->GetText(index) == m_target) {
+					reader.SetLocation(tokens->GetEnd(index));
+					return Make<SimpleValue>(context, ValueKind::Exact, tokenStart, reader);
 				}
 			}
-			return std::make_shared<SimpleValue>(ValueKind::Exact, start, reader);
+
+			if (!MatchTarget(reader)) {
+				return RewindWithError(start, reader, context, FailureKind::Exact, m_target);
+			}
+			return Make<SimpleValue>(context, ValueKind::Exact, tokenStart, reader);
+		}
+
+		bool Skip(IReader& reader, ParseContext& context) const override {
+			Location start = reader.GetLocation();
+			skipWs();
+			if (!MatchTarget(reader)) {
+				reader.SetLocation(start);
+				return false;
+			}
+			return true;
+		}
+
+		void CollectFirst(FirstSet& first, std::vector<void const*>&) const override {
+			if (m_target.empty()) {
+				first.nullable = true;
+			} else {
+				first = first | FirstSet::Of(m_target.substr(0, 1));
+			}
+		}
+
+		void Compile(ProgramBuilder& builder) const override {
+			builder.Emit(Opcode::Literal, builder.AddToken(this));
 		}
 
 		[[nodiscard]] std::string_view GetTarget() const {
 			return m_target;
 		}
+
+	private:
+		// stops at the first mismatch
+		bool MatchTarget(IReader& reader) const {
+			for (char c: m_target) {
+				if (reader.GetChar() != static_cast<unsigned char>(c) || !reader.Move()) {
+					return false;
+				}
+			}
+			return true;
+		}
 	};
 
 	inline static std::shared_ptr<IToken> Exact(std::string_view target, std::shared_ptr<IToken> ignoreWS) {
 		return std::make_shared<ExactToken>(std::move(target), std::move(ignoreWS));
 	}
 
+	// The longest of a set of ASCII literals, found in one pass over a trie of them instead of trying each literal
+	// after the other. The result is a LiteralValue telling which literal matched.
+	class LiteralSetToken : public IToken {
+		constexpr static uint16_t NoLiteral = UINT16_MAX;
+
+		// node 0 is the root, which no edge leads to, so 0 marks a missing edge
+		struct Node {
+			std::array<uint16_t, 0x80> next{};
+			uint16_t literal{NoLiteral};
+		};
+
+		std::vector<std::string_view> m_literals;
+		std::vector<Node> m_nodes{1};
+		std::string m_expected{};
+		std::shared_ptr<IToken> m_ignoreWS;
+
+	public:
+		LiteralSetToken(std::vector<std::string_view> literals, std::shared_ptr<IToken> ignoreWS) :
+			m_literals{std::move(literals)},
+			m_ignoreWS{std::move(ignoreWS)} {
+			for (size_t i = 0; i < m_literals.size(); ++i) {
+				Insert(m_literals[i], static_cast<uint16_t>(i));
+
+				m_expected += i == 0 ? "" : i + 1 == m_literals.size() ? " or " : ", ";
+				m_expected += "'" + std::string(m_literals[i]) + "'";
+			}
+		}
+
+		~LiteralSetToken() override = default;
+
+		std::shared_ptr<ITokenValue> Consume(IReader& reader, ParseContext& context) const override {
+			Location start = reader.GetLocation();
+			skipWs();
+			Location tokenStart = reader.GetLocation();
+
+			uint16_t literal = MatchLongest(reader);
+			if (literal == NoLiteral) {
+				return RewindWithError(start, reader, context, FailureKind::Literals, m_expected);
+			}
+			return Make<LiteralValue>(context, literal, tokenStart, reader);
+		}
+
+		bool Skip(IReader& reader, ParseContext& context) const override {
+			Location start = reader.GetLocation();
+			skipWs();
+			if (MatchLongest(reader) == NoLiteral) {
+				reader.SetLocation(start);
+				return false;
+			}
+			return true;
+		}
+
+		void CollectFirst(FirstSet& first, std::vector<void const*>&) const override {
+			for (size_t c = 0; c < 0x80; ++c) {
+				if (m_nodes[0].next[c] != 0) {
+					first.chars.set(c);
+				}
+			}
+			first.nullable |= m_nodes[0].literal != NoLiteral;
+		}
+
+		[[nodiscard]] std::vector<std::string_view> const& GetLiterals() const {
+			return m_literals;
+		}
+
+	private:
+		void Insert(std::string_view literal, uint16_t index) {
+			uint16_t node = 0;
+			for (char c: literal) {
+				auto byte = static_cast<unsigned char>(c) & 0x7F;
+				if (m_nodes[node].next[byte] == 0) {
+					m_nodes[node].next[byte] = static_cast<uint16_t>(m_nodes.size());
+					m_nodes.emplace_back();
+				}
+				node = m_nodes[node].next[byte];
+			}
+			// the first of equal literals wins, as it would in a choice
+			if (m_nodes[node].literal == NoLiteral) {
+				m_nodes[node].literal = index;
+			}
+		}
+
+		// Follows the trie as far as the input allows and leaves the reader at the end of the longest literal on the
+		// way. Without one it stays where the walk stopped, which is where the failure is reported.
+		uint16_t MatchLongest(IReader& reader) const {
+			uint16_t literal = NoLiteral;
+			Location end{};
+			uint16_t node = 0;
+			while (true) {
+				if (m_nodes[node].literal != NoLiteral) {
+					literal = m_nodes[node].literal;
+					end = reader.GetLocation();
+				}
+				uint32_t c = reader.GetChar();
+				if (c >= 0x80 || m_nodes[node].next[c] == 0 || !reader.Move()) {
+					break;
+				}
+				node = m_nodes[node].next[c];
+			}
+			if (literal != NoLiteral) {
+				reader.SetLocation(end);
+			}
+			return literal;
+		}
+	};
+
+	inline static std::shared_ptr<IToken> Literals(
+		std::vector<std::string_view> literals,
+		std::shared_ptr<IToken> ignoreWS
+	) {
+		return std::make_shared<LiteralSetToken>(std::move(literals), std::move(ignoreWS));
+	}
+
 	class IgnoreAnyToken : public IToken {
 		std::vector<std::shared_ptr<IToken>> m_tokens;
 		std::shared_ptr<IToken> m_ignoreWS;
@@ -253,7 +1103,13 @@ namespace funcc::parser {
 
 		~IgnoreAnyToken() override = default;
 
-		std::shared_ptr<ITokenValue> Consume(IReader& reader) const override {
+		std::shared_ptr<ITokenValue> Consume(IReader& reader, ParseContext& context) const override {
+			Location start = reader.GetLocation();
+			Skip(reader, context);
+			return Make<SimpleValue>(context, ValueKind::Ignore, start, reader);
+		}
+
+		bool Skip(IReader& reader, ParseContext& context) const override {
 			Location start = reader.GetLocation();
 			skipWs();
 
@@ -262,14 +1118,20 @@ namespace funcc::parser {
 				consumed = false;
 				for (auto& token: m_tokens) {
 					skipWs();
-					std::shared_ptr<ITokenValue> result = token->Consume(reader);
-					if (result->HasValue()) {
+					if (token->Skip(reader, context)) {
 						consumed = true;
 						break;
 					}
 				}
 			}
-			return std::make_shared<SimpleValue>(ValueKind::Ignore, start, reader);
+			return start < reader.GetLocation();
+		}
+
+		void CollectFirst(FirstSet& first, std::vector<void const*>& visiting) const override {
+			for (auto& token: m_tokens) {
+				token->CollectFirst(first, visiting);
+			}
+			first.nullable = true;
 		}
 	};
 
@@ -280,9 +1142,54 @@ namespace funcc::parser {
 		return std::make_shared<IgnoreAnyToken>(std::move(tokens), std::move(ignoreWS));
 	}
 
+	// Alternatives of a choice grouped by the first character they accept. It is filled on first use, when all
+	// forward declarations of the grammar have been replaced, so choices only try alternatives that can match.
+	class FirstDispatch {
+		mutable std::once_flag m_once{};
+		mutable std::array<uint32_t, 257> m_offsets{};
+		mutable std::vector<uint16_t> m_indices{};
+
+	public:
+		FirstDispatch() = default;
+
+		~FirstDispatch() = default;
+
+		template<typename F>
+		void ForEachCandidate(std::vector<std::shared_ptr<IToken>> const& tokens, uint32_t c, F&& f) const {
+			std::call_once(m_once, [this, &tokens]() { Build(tokens); });
+
+			size_t slot = FirstSet::Slot(c);
+			for (size_t i = m_offsets[slot]; i < m_offsets[slot + 1]; ++i) {
+				if (!f(tokens[m_indices[i]])) {
+					break;
+				}
+			}
+		}
+
+	private:
+		void Build(std::vector<std::shared_ptr<IToken>> const& tokens) const {
+			std::vector<FirstSet> firsts{};
+			firsts.reserve(tokens.size());
+			for (auto& token: tokens) {
+				firsts.push_back(token->GetFirst());
+			}
+
+			for (size_t slot = 0; slot < 256; ++slot) {
+				m_offsets[slot] = static_cast<uint32_t>(m_indices.size());
+				for (size_t i = 0; i < tokens.size(); ++i) {
+					if (firsts[i].nullable || firsts[i].chars.test(slot)) {
+						m_indices.push_back(static_cast<uint16_t>(i));
+					}
+				}
+			}
+			m_offsets[256] = static_cast<uint32_t>(m_indices.size());
+		}
+	};
+
 	class OneOfToken : public IToken {
 		std::vector<std::shared_ptr<IToken>> m_tokens;
 		std::shared_ptr<IToken> m_ignoreWS;
+		FirstDispatch m_dispatch{};
 
 	public:
 		OneOfToken(std::vector<std::shared_ptr<IToken>>&& tokens, std::shared_ptr<IToken> ignoreWS) :
@@ -291,24 +1198,53 @@ namespace funcc::parser {
 
 		~OneOfToken() override = default;
 
-		std::shared_ptr<ITokenValue> Consume(IReader& reader) const override {
-			Location start = reader.GetLocation();
-			skipWs();
+		std::shared_ptr<ITokenValue> Consume(IReader& reader, ParseContext& context) const override {
+			return Memoize(this, reader, context, [this, &reader, &context]() {
+				Location start = reader.GetLocation();
+				skipWs();
 
-			std::shared_ptr<ITokenValue> furthestError{};
+				std::shared_ptr<ITokenValue> value{};
 
-			for (auto& token: m_tokens) {
-				std::shared_ptr<ITokenValue> result = token->Consume(reader);
-				if (result->HasValue()) {
-					return result;
+				auto attempt = [&reader, &context, &value](std::shared_ptr<IToken> const& token) {
+					std::shared_ptr<ITokenValue> result = token->Consume(reader, context);
+					if (result->HasValue()) {
+						value = result;
+						return false;
+					}
+					return true;
+				};
+
+				// alternatives skip the same trivia, so the current character is the one they start with
+				if (m_ignoreWS) {
+					m_dispatch.ForEachCandidate(m_tokens, reader.GetChar(), attempt);
+				} else {
+					for (auto& token: m_tokens) {
+						if (!attempt(token)) {
+							break;
+						}
+					}
 				}
-				if (!furthestError || furthestError->GetRange() < result->GetRange()) {
-					furthestError = result;
+
+				if (value) {
+					return value;
 				}
+				// alternatives that were tried recorded their own failures, ones at this position take precedence
+				return RewindWithError(start, reader, context, FailureKind::UnexpectedCharacter);
+			});
+		}
+
+		void CollectFirst(FirstSet& first, std::vector<void const*>& visiting) const override {
+			for (auto& token: m_tokens) {
+				token->CollectFirst(first, visiting);
 			}
+		}
 
-			reader.SetLocation(start);
-			return furthestError;
+		void Compile(ProgramBuilder& builder) const override {
+			size_t enter = builder.Emit(Opcode::MemoEnter, builder.AddToken(this));
+			builder.CompileTrivia(m_ignoreWS);
+			builder.CompileAlternatives(m_tokens, m_ignoreWS != nullptr, false);
+			builder.Emit(Opcode::MemoLeave);
+			builder.SetTarget(enter, builder.Here());
 		}
 	};
 
@@ -340,23 +1276,55 @@ namespace funcc::parser {
 
 		~AllToken() override = default;
 
-		std::shared_ptr<ITokenValue> Consume(IReader& reader) const override {
-			Location start = reader.GetLocation();
+		std::shared_ptr<ITokenValue> Consume(IReader& reader, ParseContext& context) const override {
+			return Memoize(this, reader, context, [this, &reader, &context]() -> std::shared_ptr<ITokenValue> {
+				Location start = reader.GetLocation();
 
-			std::vector<std::shared_ptr<ITokenValue>> results{};
+				std::vector<std::shared_ptr<ITokenValue>> results{};
 
-			for (auto& token: m_tokens) {
-				std::shared_ptr<ITokenValue> result = token->Consume(reader);
-				if (!result->HasValue()) {
-					reader.SetLocation(start);
-					return result;
+				for (auto& token: m_tokens) {
+					std::shared_ptr<ITokenValue> result = token->Consume(reader, context);
+					if (!result->HasValue()) {
+						reader.SetLocation(start);
+						return result;
+					}
+
+					if (m_filter(result)) {
+						results.push_back(result);
+					}
 				}
+				return Make<MultiValue>(context, start, reader, std::move(results));
+			});
+		}
 
-				if (m_filter(result)) {
-					results.push_back(result);
+		void CollectFirst(FirstSet& first, std::vector<void const*>& visiting) const override {
+			for (auto& token: m_tokens) {
+				FirstSet item{};
+				token->CollectFirst(item, visiting);
+				first.chars |= item.chars;
+				if (!item.nullable) {
+					return;
 				}
 			}
-			return std::make_shared<MultiValue>(start, reader, std::move(results));
+			first.nullable = true;
+		}
+
+		void Compile(ProgramBuilder& builder) const override {
+			// other filters cannot be compiled, such a token is called as a whole
+			auto filter = m_filter.target<bool (*)(std::shared_ptr<ITokenValue> const&)>();
+			if (!filter || *filter != &FilterIgnored) {
+				IToken::Compile(builder);
+				return;
+			}
+
+			size_t enter = builder.Emit(Opcode::MemoEnter, builder.AddToken(this));
+			builder.Emit(Opcode::Open);
+			for (auto& token: m_tokens) {
+				builder.Compile(*token);
+			}
+			builder.Emit(Opcode::CaptureAll);
+			builder.Emit(Opcode::MemoLeave);
+			builder.SetTarget(enter, builder.Here());
 		}
 	};
 
@@ -374,6 +1342,10 @@ namespace funcc::parser {
 		std::shared_ptr<IToken> m_alternative{};
 
 	public:
+		// returned for every skipped optional, it carries no range
+		inline static std::shared_ptr<ITokenValue> const Skipped =
+			std::make_shared<ITokenValue>(ValueKind::SkippedOptional, Range{});
+
 		OptionalToken(
 			std::shared_ptr<IToken> token,
 			std::shared_ptr<IToken> dependent = nullptr,
@@ -385,29 +1357,69 @@ namespace funcc::parser {
 
 		~OptionalToken() override = default;
 
-		std::shared_ptr<ITokenValue> Consume(IReader& reader) const override {
+		std::shared_ptr<ITokenValue> Consume(IReader& reader, ParseContext& context) const override {
 			Location start = reader.GetLocation();
 
-			std::shared_ptr<ITokenValue> result = m_token->Consume(reader);
+			std::shared_ptr<ITokenValue> result = m_token->Consume(reader, context);
 			if (result->HasError()) {
 				if (m_alternative) {
-					std::shared_ptr<ITokenValue> altValue = m_alternative->Consume(reader);
+					std::shared_ptr<ITokenValue> altValue = m_alternative->Consume(reader, context);
 					if (altValue->HasError()) {
 						reader.SetLocation(start);
 					}
 					return altValue;
 				}
-				return std::make_shared<SimpleValue>(ValueKind::SkippedOptional, reader.GetLocation(), reader);
+				return Skipped;
 			}
 			if (!m_dependent) {
 				return result;
 			}
-			std::shared_ptr<ITokenValue> value = m_dependent->Consume(reader);
+			std::shared_ptr<ITokenValue> value = m_dependent->Consume(reader, context);
 			if (value->HasError()) {
 				reader.SetLocation(start);
 			}
 			return value;
 		}
+
+		void CollectFirst(FirstSet& first, std::vector<void const*>& visiting) const override {
+			FirstSet token{};
+			m_token->CollectFirst(token, visiting);
+			if (token.nullable && m_dependent) {
+				token.nullable = false;
+				m_dependent->CollectFirst(token, visiting);
+			}
+			first.chars |= token.chars;
+
+			if (m_alternative) {
+				FirstSet alternative{};
+				m_alternative->CollectFirst(alternative, visiting);
+				first.chars |= alternative.chars;
+				first.nullable = first.nullable || token.nullable || alternative.nullable;
+			} else {
+				first.nullable = true;
+			}
+		}
+
+		void Compile(ProgramBuilder& builder) const override {
+			size_t choice = builder.Emit(Opcode::Choice);
+			builder.Compile(*m_token);
+			size_t matched = builder.Emit(Opcode::Commit);
+
+			builder.SetTarget(choice, builder.Here());
+			if (m_alternative) {
+				builder.Compile(*m_alternative);
+			} else {
+				builder.Emit(Opcode::Skipped);
+			}
+			size_t skipped = builder.Emit(Opcode::Jump);
+
+			builder.SetTarget(matched, builder.Here());
+			if (m_dependent) {
+				builder.Emit(Opcode::Drop);
+				builder.Compile(*m_dependent);
+			}
+			builder.SetTarget(skipped, builder.Here());
+		}
 	};
 
 	inline static std::shared_ptr<IToken> Optional(
@@ -450,12 +1462,12 @@ namespace funcc::parser {
 
 		~SomeToken() override = default;
 
-		std::shared_ptr<ITokenValue> Consume(IReader& reader) const override {
+		std::shared_ptr<ITokenValue> Consume(IReader& reader, ParseContext& context) const override {
 			Location start = reader.GetLocation();
 			skipWs();
 
 			if (m_prefix) {
-				std::shared_ptr<ITokenValue> prefix = m_prefix->Consume(reader);
+				std::shared_ptr<ITokenValue> prefix = m_prefix->Consume(reader, context);
 				if (prefix->HasError()) {
 					reader.SetLocation(start);
 					return prefix;
@@ -467,12 +1479,17 @@ namespace funcc::parser {
 			while (true) {
 				skipWs();
 
-				std::shared_ptr<ITokenValue> separator = m_separator->Consume(reader);
+				std::shared_ptr<ITokenValue> separator = m_separator->Consume(reader, context);
 				std::shared_ptr<ITokenValue> suffix = nullptr;
 
-				if (separator->HasError() || m_allowSeparatorBeforeSuffix || !first || m_allowEmpty) {
+				if (!m_suffix) {
+					// without a suffix the list ends at the first item that is not followed by a separator
+					if (separator->HasError() && !first) {
+						break;
+					}
+				} else if (separator->HasError() || m_allowSeparatorBeforeSuffix || !first || m_allowEmpty) {
 					skipWs();
-					suffix = m_suffix->Consume(reader);
+					suffix = m_suffix->Consume(reader, context);
 				}
 
 				if (suffix && suffix->HasValue()) {
@@ -480,7 +1497,8 @@ namespace funcc::parser {
 				}
 
 				skipWs();
-				std::shared_ptr<ITokenValue> item = ((first && m_firstItem) ? m_firstItem : m_item)->Consume(reader);
+				std::shared_ptr<IToken> const& itemToken = (first && m_firstItem) ? m_firstItem : m_item;
+				std::shared_ptr<ITokenValue> item = itemToken->Consume(reader, context);
 				if (item->HasError()) {
 					reader.SetLocation(start);
 					return item;
@@ -490,7 +1508,112 @@ namespace funcc::parser {
 				first = false;
 			}
 
-			return std::make_shared<MultiValue>(start, reader, std::move(values));
+			return Make<MultiValue>(context, start, reader, std::move(values));
+		}
+
+		void CollectFirst(FirstSet& first, std::vector<void const*>& visiting) const override {
+			if (m_prefix) {
+				FirstSet prefix{};
+				m_prefix->CollectFirst(prefix, visiting);
+				first.chars |= prefix.chars;
+				if (!prefix.nullable) {
+					return;
+				}
+			}
+
+			// a leading separator and an immediate suffix are accepted too
+			m_separator->CollectFirst(first, visiting);
+			if (m_suffix) {
+				m_suffix->CollectFirst(first, visiting);
+			}
+			(m_firstItem ? m_firstItem : m_item)->CollectFirst(first, visiting);
+			first.nullable = true;
+		}
+
+		// The first round is compiled apart, whether the suffix is tried there depends on the flags. Later rounds
+		// try it whenever there is one.
+		void Compile(ProgramBuilder& builder) const override {
+			builder.Emit(Opcode::Open);
+			builder.CompileTrivia(m_ignoreWS);
+			if (m_prefix) {
+				builder.Compile(*m_prefix);
+				builder.Emit(Opcode::Drop);
+			}
+
+			std::vector<size_t> toItem{};
+			std::vector<size_t> toSuffix{};
+			std::vector<size_t> toDone{};
+
+			auto compileSeparator = [this, &builder]() {
+				builder.CompileTrivia(m_ignoreWS);
+				size_t choice = builder.Emit(Opcode::Choice);
+				builder.Compile(*m_separator);
+				builder.Emit(Opcode::Drop);
+				size_t matched = builder.Emit(Opcode::Commit);
+				builder.SetTarget(choice, builder.Here());
+				return matched;
+			};
+
+			// first round, a failed separator falls through
+			size_t firstMatched = compileSeparator();
+			(m_suffix ? toSuffix : toItem).push_back(builder.Emit(Opcode::Jump));
+			builder.SetTarget(firstMatched, builder.Here());
+			bool suffixAfterSeparator = m_suffix && (m_allowSeparatorBeforeSuffix || m_allowEmpty);
+			(suffixAfterSeparator ? toSuffix : toItem).push_back(builder.Emit(Opcode::Jump));
+
+			uint32_t firstSuffix = builder.Here();
+			if (m_suffix) {
+				CompileSuffix(builder, toItem, toDone);
+			}
+
+			uint32_t firstItem = builder.Here();
+			if (m_firstItem) {
+				builder.CompileTrivia(m_ignoreWS);
+				builder.Compile(*m_firstItem);
+			} else {
+				toItem.push_back(builder.Emit(Opcode::Jump));
+			}
+
+			// later rounds
+			uint32_t loop = builder.Here();
+			size_t matched = compileSeparator();
+			if (!m_suffix) {
+				toDone.push_back(builder.Emit(Opcode::Jump));
+			}
+			builder.SetTarget(matched, builder.Here());
+			std::vector<size_t> toLoopItem{};
+			if (m_suffix) {
+				CompileSuffix(builder, toLoopItem, toDone);
+			}
+			uint32_t item = builder.Here();
+			builder.CompileTrivia(m_ignoreWS);
+			builder.Compile(*m_item);
+			builder.SetTarget(builder.Emit(Opcode::Jump), loop);
+
+			for (size_t jump: toSuffix) {
+				builder.SetTarget(jump, firstSuffix);
+			}
+			for (size_t jump: toItem) {
+				builder.SetTarget(jump, m_firstItem ? firstItem : item);
+			}
+			for (size_t jump: toLoopItem) {
+				builder.SetTarget(jump, item);
+			}
+			for (size_t jump: toDone) {
+				builder.SetTarget(jump, builder.Here());
+			}
+			builder.Emit(Opcode::CaptureList);
+		}
+
+	private:
+		// a matched suffix ends the list, otherwise the item follows
+		void CompileSuffix(ProgramBuilder& builder, std::vector<size_t>& toItem, std::vector<size_t>& toDone) const {
+			builder.CompileTrivia(m_ignoreWS);
+			size_t choice = builder.Emit(Opcode::Choice);
+			toItem.push_back(choice);
+			builder.Compile(*m_suffix);
+			builder.Emit(Opcode::Drop);
+			toDone.push_back(builder.Emit(Opcode::Commit));
 		}
 	};
 
@@ -536,7 +1659,7 @@ namespace funcc::parser {
 
 		~RepeatToken() override = default;
 
-		std::shared_ptr<ITokenValue> Consume(IReader& reader) const override {
+		std::shared_ptr<ITokenValue> Consume(IReader& reader, ParseContext& context) const override {
 			Location start = reader.GetLocation();
 			skipWs();
 
@@ -545,7 +1668,7 @@ namespace funcc::parser {
 				Location itemStart = reader.GetLocation();
 				skipWs();
 
-				std::shared_ptr<ITokenValue> condition = m_condition->Consume(reader);
+				std::shared_ptr<ITokenValue> condition = m_condition->Consume(reader, context);
 				reader.SetLocation(itemStart);
 
 				if (condition->HasError()) {
@@ -556,14 +1679,43 @@ namespace funcc::parser {
 					break;
 				}
 				skipWs();
-				std::shared_ptr<ITokenValue> body = m_body->Consume(reader);
+				std::shared_ptr<ITokenValue> body = m_body->Consume(reader, context);
 				if (body->HasError()) {
 					reader.SetLocation(start);
 					return body;
 				}
 				values.push_back(body);
 			}
-			return std::make_shared<MultiValue>(start, reader, std::move(values));
+			return Make<MultiValue>(context, start, reader, std::move(values));
+		}
+
+		void CollectFirst(FirstSet& first, std::vector<void const*>& visiting) const override {
+			FirstSet condition{};
+			m_condition->CollectFirst(condition, visiting);
+			if (condition.nullable) {
+				m_body->CollectFirst(condition, visiting);
+			}
+			first.chars |= condition.chars;
+			first.nullable = first.nullable || m_allowEmpty || condition.nullable;
+		}
+
+		// the condition is a lookahead, the position and values are restored after it
+		void Compile(ProgramBuilder& builder) const override {
+			builder.Emit(Opcode::Open);
+			builder.CompileTrivia(m_ignoreWS);
+
+			uint32_t loop = builder.Here();
+			size_t choice = builder.Emit(Opcode::Choice);
+			builder.CompileTrivia(m_ignoreWS);
+			builder.Compile(*m_condition);
+			size_t matched = builder.Emit(Opcode::BackCommit);
+			builder.SetTarget(matched, builder.Here());
+			builder.CompileTrivia(m_ignoreWS);
+			builder.Compile(*m_body);
+			builder.SetTarget(builder.Emit(Opcode::Jump), loop);
+
+			builder.SetTarget(choice, builder.Here());
+			builder.Emit(Opcode::CaptureList, m_allowEmpty ? 0 : 1);
 		}
 	};
 
@@ -582,19 +1734,35 @@ namespace funcc::parser {
 
 		~WhiteSpaceToken() override = default;
 
-		std::shared_ptr<ITokenValue> Consume(IReader& reader) const override {
+		std::shared_ptr<ITokenValue> Consume(IReader& reader, ParseContext& context) const override {
 			Location start = reader.GetLocation();
+			if (Skip(reader, context)) {
+				return Make<SimpleValue>(context, ValueKind::WhiteSpace, start, reader);
+			}
+			return RewindWithError(start, reader, context, FailureKind::WhiteSpace);
+		}
 
+		bool Skip(IReader& reader, ParseContext&) const override {
+			Location start = reader.GetLocation();
+			if (std::string_view rest = reader.GetRest(); !rest.empty()) {
+				reader.Advance(Scan::NonSpace(rest));
+				return start < reader.GetLocation();
+			}
 			while (true) {
 				uint32_t c = reader.GetChar();
 				if (!std::isspace(c) || !reader.Move()) {
 					break;
 				}
 			}
-			if (start < reader.GetLocation()) {
-				return std::make_shared<SimpleValue>(ValueKind::WhiteSpace, start, reader);
+			return start < reader.GetLocation();
+		}
+
+		void CollectFirst(FirstSet& first, std::vector<void const*>&) const override {
+			for (size_t c = 0; c < 0x80; ++c) {
+				if (std::isspace(static_cast<int>(c))) {
+					first.chars.set(c);
+				}
 			}
-			return RewindWithError(start, reader, "Expected whitespace");
 		}
 	};
 
@@ -611,25 +1779,45 @@ namespace funcc::parser {
 
 		~SingleLineCommentToken() override = default;
 
-		std::shared_ptr<ITokenValue> Consume(IReader& reader) const override {
+		std::shared_ptr<ITokenValue> Consume(IReader& reader, ParseContext& context) const override {
 			Location start = reader.GetLocation();
 
 			ErrorValue ignore{};
 
-			std::shared_ptr<ITokenValue> prefix = m_prefix.Consume(reader);
+			std::shared_ptr<ITokenValue> prefix = m_prefix.Consume(reader, context);
 			if (prefix->HasError()) {
 				reader.SetLocation(start);
 				return prefix;
 			}
 
+			SkipLine(reader);
+			return Make<SimpleValue>(context, ValueKind::SingleLineComment, start, reader);
+		}
+
+		bool Skip(IReader& reader, ParseContext& context) const override {
+			if (!m_prefix.Skip(reader, context)) {
+				return false;
+			}
+			SkipLine(reader);
+			return true;
+		}
+
+		void CollectFirst(FirstSet& first, std::vector<void const*>& visiting) const override {
+			m_prefix.CollectFirst(first, visiting);
+		}
+
+	private:
+		static void SkipLine(IReader& reader) {
+			if (std::string_view rest = reader.GetRest(); !rest.empty()) {
+				reader.Advance(Scan::Byte(rest, '\n'));
+				return;
+			}
 			while (true) {
 				uint32_t c = reader.GetChar();
 				if (c == '\n' || !reader.Move()) {
 					break;
 				}
 			}
-
-			return std::make_shared<SimpleValue>(ValueKind::SingleLineComment, start, reader);
 		}
 	};
 
@@ -640,25 +1828,31 @@ namespace funcc::parser {
 	class MultiLineCommentToken : public IToken {
 		ExactToken m_prefix;
 		ExactToken m_suffix;
+		// the suffix is searched for in the buffer unless trivia may come in front of it
+		bool m_scan;
 
 	public:
 		MultiLineCommentToken(std::string_view prefix, std::string_view suffix, std::shared_ptr<IToken> ignoreWS) :
 			m_prefix{std::move(prefix), ignoreWS},
-			m_suffix{std::move(suffix), ignoreWS} {}
+			m_suffix{std::move(suffix), ignoreWS},
+			m_scan{ignoreWS == nullptr} {}
 
 		~MultiLineCommentToken() override = default;
 
-		std::shared_ptr<ITokenValue> Consume(IReader& reader) const override {
+		std::shared_ptr<ITokenValue> Consume(IReader& reader, ParseContext& context) const override {
 			Location start = reader.GetLocation();
 
-			std::shared_ptr<ITokenValue> prefix = m_prefix.Consume(reader);
+			std::shared_ptr<ITokenValue> prefix = m_prefix.Consume(reader, context);
 			if (prefix->HasError()) {
 				reader.SetLocation(start);
 				return prefix;
 			}
 
+			if (SkipToSuffix(reader)) {
+				return Make<SimpleValue>(context, ValueKind::MultiLineComment, start, reader);
+			}
 			while (true) {
-				std::shared_ptr<ITokenValue> suffix = m_suffix.Consume(reader);
+				std::shared_ptr<ITokenValue> suffix = m_suffix.Consume(reader, context);
 				if (suffix->HasValue()) {
 					break;
 				}
@@ -668,7 +1862,44 @@ namespace funcc::parser {
 				}
 			}
 
-			return std::make_shared<SimpleValue>(ValueKind::MultiLineComment, start, reader);
+			return Make<SimpleValue>(context, ValueKind::MultiLineComment, start, reader);
+		}
+
+		bool Skip(IReader& reader, ParseContext& context) const override {
+			Location start = reader.GetLocation();
+			if (!m_prefix.Skip(reader, context)) {
+				return false;
+			}
+			if (SkipToSuffix(reader)) {
+				return true;
+			}
+			while (!m_suffix.Skip(reader, context)) {
+				if (!reader.Move()) {
+					reader.SetLocation(start);
+					return false;
+				}
+			}
+			return true;
+		}
+
+		void CollectFirst(FirstSet& first, std::vector<void const*>& visiting) const override {
+			m_prefix.CollectFirst(first, visiting);
+		}
+
+	private:
+		// Moves past the first suffix in the buffer. Returns false without moving when there is none, the scan above
+		// fails character by character then.
+		bool SkipToSuffix(IReader& reader) const {
+			if (!m_scan) {
+				return false;
+			}
+			std::string_view rest = reader.GetRest();
+			size_t end = Scan::Sequence(rest, m_suffix.GetTarget()) + m_suffix.GetTarget().size();
+			if (end > rest.size()) {
+				return false;
+			}
+			reader.Advance(end);
+			return true;
 		}
 	};
 
@@ -686,45 +1917,116 @@ namespace funcc::parser {
 			std::function<void(std::string_view const& acc, uint32_t next, bool& outIsValid, bool& outIsComplete)>;
 		Aggregator m_aggregator;
 		std::shared_ptr<IToken> m_ignoreWS;
+		FirstSet m_first;
 
 	public:
-		EntityToken(Aggregator aggregator, std::shared_ptr<IToken> ignoreWS) :
+		// first lists the characters a valid entity can start with, the aggregator cannot be inspected for it
+		EntityToken(Aggregator aggregator, std::shared_ptr<IToken> ignoreWS, FirstSet first = FirstSet::Any()) :
 			m_aggregator{std::move(aggregator)},
-			m_ignoreWS{std::move(ignoreWS)} {}
+			m_ignoreWS{std::move(ignoreWS)},
+			m_first{first} {}
 
 		~EntityToken() override = default;
 
-		std::shared_ptr<ITokenValue> Consume(IReader& reader) const override {
+		std::shared_ptr<ITokenValue> Consume(IReader& reader, ParseContext& context) const override {
 			Location start = reader.GetLocation();
 			skipWs();
+			Location tokenStart = reader.GetLocation();
+
+			LexemeMatch lexeme = MatchLexeme(reader, context);
+			if (lexeme == LexemeMatch::Matched) {
+				return Make<SimpleValue>(context, ValueKind::Entity, tokenStart, reader);
+			}
+			if (lexeme == LexemeMatch::Failed) {
+				return RewindWithError(start, reader, context, FailureKind::Identifier);
+			}
 
 			while (true) {
 				uint32_t c = reader.GetChar();
 				bool isValid = false;
 				bool isComplete = false;
-				m_aggregator(reader.Sub(Range{start, reader.GetLocation()}), c, isValid, isComplete);
+				m_aggregator(reader.Sub(Range{tokenStart, reader.GetLocation()}), c, isValid, isComplete);
 				if (isComplete) {
 					if (isValid) {
-						return std::make_shared<SimpleValue>(ValueKind::Entity, start, reader);
+						return Make<SimpleValue>(context, ValueKind::Entity, tokenStart, reader);
 					} else {
-						return RewindWithError(start, reader, "Invalid identifier");
+						return RewindWithError(start, reader, context, FailureKind::Identifier);
 					}
 				}
 				if (!reader.Move()) {
-					return RewindWithError(start, reader, "Invalid identifier");
+					return RewindWithError(start, reader, context, FailureKind::Identifier);
 				}
 			}
 		}
+
+		void CollectFirst(FirstSet& first, std::vector<void const*>&) const override {
+			first = first | m_first;
+		}
+	};
+
+	inline static std::shared_ptr<IToken> Entity(
+		EntityToken::Aggregator aggregator,
+		std::shared_ptr<IToken> ignoreWS,
+		FirstSet first = FirstSet::Any()
+	) {
+		return std::make_shared<EntityToken>(std::move(aggregator), std::move(ignoreWS), first);
+	}
+
+	// A run of characters from an ASCII class whose first character comes from a narrower one, scanned with one table
+	// lookup per byte. rest has to include first.
+	class WordToken : public IToken {
+		std::bitset<256> m_first;
+		std::bitset<256> m_rest;
+		std::shared_ptr<IToken> m_ignoreWS;
+
+	public:
+		WordToken(std::bitset<256> first, std::bitset<256> rest, std::shared_ptr<IToken> ignoreWS) :
+			m_first{first},
+			m_rest{rest},
+			m_ignoreWS{std::move(ignoreWS)} {}
+
+		~WordToken() override = default;
+
+		std::shared_ptr<ITokenValue> Consume(IReader& reader, ParseContext& context) const override {
+			Location start = reader.GetLocation();
+			skipWs();
+			Location tokenStart = reader.GetLocation();
+
+			LexemeMatch lexeme = MatchLexeme(reader, context);
+			if (lexeme == LexemeMatch::Matched) {
+				Symbol symbol = context.GetTokenStream()->GetSymbol(tokenStart, reader.GetLocation());
+				return Make<WordValue>(context, tokenStart, reader, symbol);
+			}
+			if (lexeme == LexemeMatch::Failed) {
+				return RewindWithError(start, reader, context, FailureKind::Identifier);
+			}
+
+			uint32_t c = reader.GetChar();
+			if (c >= 0x80 || !m_first.test(c)) {
+				return RewindWithError(start, reader, context, FailureKind::Identifier);
+			}
+			reader.SkipWhile(m_rest);
+			return Make<WordValue>(context, tokenStart, reader, Symbol{});
+		}
+
+		void CollectFirst(FirstSet& first, std::vector<void const*>&) const override {
+			first.chars |= m_first;
+		}
 	};
 
-	inline static std::shared_ptr<IToken> Entity(EntityToken::Aggregator aggregator, std::shared_ptr<IToken> ignoreWS) {
-		return std::make_shared<EntityToken>(std::move(aggregator), std::move(ignoreWS));
+	inline static std::shared_ptr<IToken> Word(
+		std::bitset<256> first,
+		std::bitset<256> rest,
+		std::shared_ptr<IToken> ignoreWS
+	) {
+		return std::make_shared<WordToken>(first, rest, std::move(ignoreWS));
 	}
 
 	class StringLiteralToken : public IToken {
 		ExactToken m_prefix;
 		ExactToken m_suffix;
 		ExactToken m_escape;
+		std::shared_ptr<IToken> m_ignoreWS;
 		std::string_view m_value{};
 
 	public:
@@ -734,30 +2036,45 @@ namespace funcc::parser {
 			std::string_view escape,
 			std::shared_ptr<IToken> ignoreWS
 		) :
-			m_prefix{std::move(prefix), ignoreWS},
+			m_prefix{std::move(prefix), nullptr},
 			m_suffix{std::move(suffix), nullptr},
-			m_escape{std::move(escape), nullptr} {}
+			m_escape{std::move(escape), nullptr},
+			m_ignoreWS{std::move(ignoreWS)} {}
 
 		~StringLiteralToken() override = default;
 
-		std::shared_ptr<ITokenValue> Consume(IReader& reader) const override {
+		std::shared_ptr<ITokenValue> Consume(IReader& reader, ParseContext& context) const override {
 			Location start = reader.GetLocation();
+			skipWs();
+			Location tokenStart = reader.GetLocation();
+
+			LexemeMatch lexeme = MatchLexeme(reader, context);
+			if (lexeme == LexemeMatch::Matched) {
+				return Make<SimpleValue>(context, ValueKind::StringLiteral, tokenStart, reader);
+			}
 
-			std::shared_ptr<ITokenValue> result = m_prefix.Consume(reader);
+			std::shared_ptr<ITokenValue> result = m_prefix.Consume(reader, context);
 			if (result->HasError()) {
 				reader.SetLocation(start);
 				return result;
 			}
 
-			bool escaped = false;
+			size_t end = FindEnd(reader.GetRest());
+			if (end != std::string_view::npos) {
+				reader.Advance(end);
+				return Make<SimpleValue>(context, ValueKind::StringLiteral, tokenStart, reader);
+			}
+
 			while (true) {
-				if (!escaped) {
-					if (m_escape.Consume(reader)->HasValue()) {
-						escaped = true;
+				// the character after an escape cannot end the literal
+				if (m_escape.Skip(reader, context)) {
+					if (!reader.Move()) {
+						return RewindWithError(start, reader, context, FailureKind::Exact, m_suffix.GetTarget());
 					}
+					continue;
 				}
-				std::shared_ptr<ITokenValue> suffix = m_suffix.Consume(reader);
-				if (!escaped && suffix->HasValue()) {
+				std::shared_ptr<ITokenValue> suffix = m_suffix.Consume(reader, context);
+				if (suffix->HasValue()) {
 					break;
 				}
 				if (!reader.Move()) {
@@ -765,7 +2082,39 @@ namespace funcc::parser {
 					return suffix;
 				}
 			}
-			return std::make_shared<SimpleValue>(ValueKind::StringLiteral, start, reader);
+			return Make<SimpleValue>(context, ValueKind::StringLiteral, tokenStart, reader);
+		}
+
+		void CollectFirst(FirstSet& first, std::vector<void const*>& visiting) const override {
+			m_prefix.CollectFirst(first, visiting);
+		}
+
+	private:
+		// Offset just past the suffix that closes the literal, npos when the text does not close it. Only the first
+		// bytes of the escape and the suffix stop the scan.
+		size_t FindEnd(std::string_view text) const {
+			std::string_view escape = m_escape.GetTarget();
+			std::string_view suffix = m_suffix.GetTarget();
+			if (escape.empty() || suffix.empty()) {
+				return std::string_view::npos;
+			}
+			size_t offset = 0;
+			while (offset < text.size()) {
+				offset += Scan::EitherByte(text.substr(offset), escape[0], suffix[0]);
+				std::string_view rest = text.substr(offset);
+				if (rest.empty()) {
+					break;
+				}
+				if (rest.substr(0, escape.size()) == escape) {
+					// a multibyte escaped character leaves the scan on a continuation byte, which stops nothing
+					offset += escape.size() + 1;
+				} else if (rest.substr(0, suffix.size()) == suffix) {
+					return offset + suffix.size();
+				} else {
+					offset++;
+				}
+			}
+			return std::string_view::npos;
 		}
 	};
 
@@ -793,26 +2142,33 @@ namespace funcc::parser {
 
 		~NumberLiteralToken() override = default;
 
-		std::shared_ptr<ITokenValue> Consume(IReader& reader) const override {
+		std::shared_ptr<ITokenValue> Consume(IReader& reader, ParseContext& context) const override {
 			Location start = reader.GetLocation();
 			skipWs();
+			Location tokenStart = reader.GetLocation();
 
-			char const* begin = reader.Sub(Range{reader.GetLocation(), reader.GetLocation()}).data();
-			char* end = nullptr;
-			double val = strtod(begin, &end);
-
-			if (val == HUGE_VAL || end == begin) {
-				return RewindWithError(start, reader, "Expected number");
+			LexemeMatch lexeme = MatchLexeme(reader, context);
+			if (lexeme == LexemeMatch::Matched) {
+				Number number = Number::Scan(reader.Sub(Range{tokenStart, reader.GetLocation()}));
+				return Make<NumberLiteralValue>(context, tokenStart, reader, number);
 			}
 
-			size_t len = end - begin;
-			while (len--) {
-				if (!reader.Move()) {
-					return RewindWithError(start, reader, "Expected number");
-				}
+			// the lexer does not match a literal out of range either, it is scanned again to tell it from no literal
+			Number number = Number::Scan(reader.GetRest());
+			if (number.outOfRange) {
+				// the text is a number whatever else could read it, so no other alternative may take it
+				context.GetFailures().RecordFatal(tokenStart, FailureKind::NumberOutOfRange);
+				return RewindWithError(start, reader, context, FailureKind::NumberOutOfRange);
+			}
+			if (lexeme == LexemeMatch::Failed || number.length == Number::NoMatch) {
+				return RewindWithError(start, reader, context, FailureKind::Number);
 			}
+			reader.Advance(number.length);
+			return Make<NumberLiteralValue>(context, tokenStart, reader, number);
+		}
 
-			return std::make_shared<NumberLiteralValue>(start, reader);
+		void CollectFirst(FirstSet& first, std::vector<void const*>&) const override {
+			first = first | FirstSet::Of("0123456789+-.");
 		}
 	};
 
@@ -835,12 +2191,28 @@ namespace funcc::parser {
 
 		~MapToken() override = default;
 
-		std::shared_ptr<ITokenValue> Consume(IReader& reader) const override {
-			std::shared_ptr<ITokenValue> result = m_token->Consume(reader);
+		std::shared_ptr<ITokenValue> Consume(IReader& reader, ParseContext& context) const override {
+			Location start = reader.GetLocation();
+			std::shared_ptr<ITokenValue> result = m_token->Consume(reader, context);
 			if (result->HasError()) {
 				return result;
 			}
-			return m_mapper(result);
+
+			std::shared_ptr<ITokenValue> mapped = m_mapper(result);
+			if (mapped->HasError()) {
+				context.GetFailures().RecordMapped(mapped);
+				reader.SetLocation(start);
+			}
+			return mapped;
+		}
+
+		void CollectFirst(FirstSet& first, std::vector<void const*>& visiting) const override {
+			m_token->CollectFirst(first, visiting);
+		}
+
+		void Compile(ProgramBuilder& builder) const override {
+			builder.Compile(*m_token);
+			builder.Emit(Opcode::Map, builder.AddMapper(m_mapper));
 		}
 	};
 
@@ -857,12 +2229,16 @@ namespace funcc::parser {
 
 		~EOFToken() override = default;
 
-		std::shared_ptr<ITokenValue> Consume(IReader& reader) const override {
+		std::shared_ptr<ITokenValue> Consume(IReader& reader, ParseContext& context) const override {
 			skipWs();
 			if (reader.GetChar() == 0) {
-				return std::make_shared<SimpleValue>(ValueKind::WhiteSpace, reader.GetLocation(), reader);
+				return Make<SimpleValue>(context, ValueKind::WhiteSpace, reader.GetLocation(), reader);
 			}
-			return RewindWithError(reader.GetLocation(), reader, "Expected end of file");
+			return RewindWithError(reader.GetLocation(), reader, context, FailureKind::EndOfFile);
+		}
+
+		void CollectFirst(FirstSet& first, std::vector<void const*>&) const override {
+			first.chars.set(0);
 		}
 	};
 
@@ -881,11 +2257,19 @@ namespace funcc::parser {
 
 		~DebugToken() override = default;
 
-		__forceinline std::shared_ptr<ITokenValue> Consume(IReader& reader) const override {
+		__forceinline std::shared_ptr<ITokenValue> Consume(IReader& reader, ParseContext& context) const override {
 #ifdef FUNCC_DEBUG_TOKEN
 			FUNCC_DEBUG_TOKEN_BREAK(m_name.c_str());
 #endif
-			return m_token->Consume(reader);
+			return m_token->Consume(reader, context);
+		}
+
+		void CollectFirst(FirstSet& first, std::vector<void const*>& visiting) const override {
+			m_token->CollectFirst(first, visiting);
+		}
+
+		void Compile(ProgramBuilder& builder) const override {
+			builder.Compile(*m_token);
 		}
 	};
 
@@ -895,39 +2279,173 @@ namespace funcc::parser {
 
 	class ForwardDeclarationToken : public IToken {
 		std::vector<std::shared_ptr<IToken>> m_token{};
-		mutable int m_recursionDepth{0};
+		std::shared_ptr<IToken> m_ignoreWS{};
+		FirstDispatch m_dispatch{};
+		// index of the recursion depth of this declaration in a parse context
+		size_t m_slot{ParseContext::NewDepthSlot()};
+		mutable FirstSet m_first{};
+		mutable bool m_firstDone{false};
 
 	public:
 		class Replacement {
 		public:
-			Replacement(std::shared_ptr<IToken> target, std::vector<std::shared_ptr<IToken>> replacement) {
-				std::dynamic_pointer_cast<ForwardDeclarationToken>(target)->m_token = std::move(replacement);
+			// with ignoreWS the alternatives are picked by the first character after the trivia
+			Replacement(
+				std::shared_ptr<IToken> target,
+				std::vector<std::shared_ptr<IToken>> replacement,
+				std::shared_ptr<IToken> ignoreWS = nullptr
+			) {
+				auto declaration = std::dynamic_pointer_cast<ForwardDeclarationToken>(target);
+				declaration->m_token = std::move(replacement);
+				declaration->m_ignoreWS = std::move(ignoreWS);
 			}
 		};
 
 		~ForwardDeclarationToken() override = default;
 
-		std::shared_ptr<ITokenValue> Consume(IReader& reader) const override {
-			m_recursionDepth++;
-			if (m_recursionDepth > 256) {
-				return std::make_shared<ErrorValue>(
-					Range{reader.GetLocation(), reader.GetLocation()},
-					"Forward declaration recursion limit exceeded"
-				);
+		std::shared_ptr<ITokenValue> Consume(IReader& reader, ParseContext& context) const override {
+			return ConsumeRule(this, m_slot, m_ignoreWS.get(), reader, context, [this, &reader, &context]() {
+				return ConsumeAlternatives(reader, context);
+			});
+		}
+
+		// Left recursive alternatives start with the declaration itself, so the set is grown to a fixed point.
+		// Only the outermost expansion is final, nested ones may have seen an incomplete set of an enclosing one.
+		void CollectFirst(FirstSet& first, std::vector<void const*>& visiting) const override {
+			if (m_firstDone || std::find(visiting.begin(), visiting.end(), this) != visiting.end()) {
+				first = first | m_first;
+				return;
 			}
 
-			std::shared_ptr<ITokenValue> result{};
-			for (auto& token: m_token) {
-				result = token->Consume(reader);
-				if (result->HasValue()) {
+			visiting.push_back(this);
+			while (true) {
+				FirstSet next = m_first;
+				for (auto& token: m_token) {
+					token->CollectFirst(next, visiting);
+				}
+				if (next.chars == m_first.chars && next.nullable == m_first.nullable) {
 					break;
 				}
+				m_first = next;
+			}
+			visiting.pop_back();
+
+			m_firstDone = visiting.empty();
+			first = first | m_first;
+		}
+
+		void Compile(ProgramBuilder& builder) const override {
+			builder.CompileCall(this, m_slot, m_ignoreWS.get(), m_token);
+		}
+
+		// The recursion limit, the trivia and the left recursion of a rule. `alternatives` matches the rule at the
+		// reader, a null result means no alternative could start there. Shared with the rules of the fixed grammar.
+		template<typename F>
+		static std::shared_ptr<ITokenValue> ConsumeRule(
+			void const* key,
+			size_t slot,
+			IToken const* ignoreWS,
+			IReader& reader,
+			ParseContext& context,
+			F&& alternatives
+		) {
+			// checked before the memo lookup: hitting the limit depends on the caller, not on the input
+			if (context.GetDepth(slot) >= 256) {
+				return RewindWithError(reader.GetLocation(), reader, context, FailureKind::RecursionLimit);
+			}
+
+			// memo entries are keyed after the trivia, where left recursive alternatives call back in
+			Location start = reader.GetLocation();
+			if (ignoreWS) {
+				SkipTrivia(*ignoreWS, reader, context);
+			}
+
+			auto consume = [&reader, &context, &alternatives]() {
+				std::shared_ptr<ITokenValue> result = alternatives();
+				if (!result) {
+					return RewindWithError(reader.GetLocation(), reader, context, FailureKind::UnexpectedCharacter);
+				}
+				return result;
+			};
+
+			context.GetDepth(slot)++;
+			std::shared_ptr<ITokenValue> result = ConsumeGrowing(key, reader, context.GetMemoTable(), consume);
+			context.GetDepth(slot)--;
+
+			if (result->HasError()) {
+				reader.SetLocation(start);
+			}
+			return result;
+		}
+
+	private:
+		std::shared_ptr<ITokenValue> ConsumeAlternatives(IReader& reader, ParseContext& context) const {
+			if (!m_ignoreWS) {
+				std::shared_ptr<ITokenValue> result{};
+				for (auto& token: m_token) {
+					result = token->Consume(reader, context);
+					if (result->HasValue()) {
+						break;
+					}
+				}
+				return result;
+			}
+
+			std::shared_ptr<ITokenValue> result{};
+			m_dispatch.ForEachCandidate(m_token, reader.GetChar(), [&reader, &context, &result](auto const& token) {
+				result = token->Consume(reader, context);
+				return result->HasError();
+			});
+			return result;
+		}
+
+		// Left recursion by growing the seed (Warth et al.): a recursive call at the same position gets the last
+		// result from the pending memo entry instead of recursing again, and the alternatives are re-run while
+		// they consume more input than the previous attempt.
+		template<typename F>
+		static std::shared_ptr<ITokenValue> ConsumeGrowing(
+			void const* key,
+			IReader& reader,
+			MemoTable& memo,
+			F&& consume
+		) {
+			Location start = reader.GetLocation();
+
+			if (MemoTable::Entry* entry = memo.Find(key, start.position)) {
+				if (entry->pending) {
+					entry->leftRecursive = true;
+				}
+				reader.SetLocation(entry->end);
+				return entry->result;
+			}
+
+			// a recursive call that finds the seed fails, so only the alternatives without left recursion match
+			memo.Store(key, start.position, Failed, start, true);
+
+			std::shared_ptr<ITokenValue> result = consume();
+			Location end = reader.GetLocation();
+
+			if (result->HasValue() && memo.Lookup(key, start.position)->leftRecursive) {
+				while (true) {
+					memo.Store(key, start.position, result, end, true);
+					memo.Invalidate(start.position);
+					reader.SetLocation(start);
+
+					std::shared_ptr<ITokenValue> grown = consume();
+					if (grown->HasError() || !(end < reader.GetLocation())) {
+						break;
+					}
+					result = grown;
+					end = reader.GetLocation();
+				}
+				reader.SetLocation(end);
 			}
 
-			m_recursionDepth--;
+			memo.Store(key, start.position, result, end);
 			return result;
 		}
 
+	public:
 		friend class Replacement;
 	};
 
@@ -2,94 +2,209 @@
 
 #include "_external.hh"
 #include "ast_common.hh"
+#include "scan.hh"
+#include "utf8.hh"
 
 namespace funcc {
+	class Utf8Reader;
+
+	// Cursor over a source. Calls on a Utf8Reader are bound statically and inlined into the tokens, other sources
+	// implement the protected virtual members.
 	class IReader {
+		// the reader itself when it is a Utf8Reader
+		Utf8Reader* m_utf8;
+
 	public:
+		IReader(IReader const&) = delete;
+		IReader& operator=(IReader const&) = delete;
+
 		virtual ~IReader() = default;
 
-		[[nodiscard]] virtual uint32_t GetChar() const = 0;
-		[[nodiscard]] virtual Location GetLocation() const = 0;
-		[[nodiscard]] virtual std::string_view Sub(Range const& range) const = 0;
+		[[nodiscard]] uint32_t GetChar() const;
+		[[nodiscard]] Location GetLocation() const;
+		[[nodiscard]] std::string_view Sub(Range const& range) const;
+
+		// moves to the next character, returns false at the end of the input where it stays
+		bool Move();
+		void SetLocation(Location location);
+
+		// the input from the current position on, empty when there is no buffer to scan
+		[[nodiscard]] std::string_view GetRest() const;
+
+		// moves over the given number of bytes, they must end where a character starts
+		void Advance(size_t bytes);
+
+		// moves over the characters of the ASCII class, returns the number of bytes
+		size_t SkipWhile(std::bitset<256> const& ascii) {
+			size_t start = GetLocation().position;
+			if (std::string_view rest = GetRest(); !rest.empty()) {
+				Advance(Scan::While(rest, ascii));
+			} else {
+				while (GetChar() < 0x80 && ascii.test(GetChar()) && Move()) {
+				}
+			}
+			return GetLocation().position - start;
+		}
+
+	protected:
+		IReader() :
+			m_utf8{nullptr} {}
+
+		explicit IReader(Utf8Reader* utf8) :
+			m_utf8{utf8} {}
 
-		virtual bool Move() = 0;
-		virtual void SetLocation(Location location) = 0;
+		[[nodiscard]] virtual uint32_t DoGetChar() const = 0;
+		[[nodiscard]] virtual Location DoGetLocation() const = 0;
+		[[nodiscard]] virtual std::string_view DoSub(Range const& range) const = 0;
+		virtual bool DoMove() = 0;
+		virtual void DoSetLocation(Location location) = 0;
+
+		[[nodiscard]] virtual std::string_view DoGetRest() const {
+			return {};
+		}
+
+		virtual void DoAdvance(size_t bytes) {
+			size_t target = GetLocation().position + bytes;
+			while (GetLocation().position < target && Move()) {
+			}
+		}
 	};
 
-	class Utf8Reader : public IReader {
+	// Reads a buffer that was checked with Utf8::Validate. A pure ASCII buffer is read a byte at a time without
+	// decoding.
+	class Utf8Reader final : public IReader {
 		std::string_view m_buffer;
 		Location m_location;
 		uint32_t m_currentChar;
 		size_t m_currentLength;
+		bool m_ascii;
 
 	public:
-		Utf8Reader(std::string_view buffer) :
+		Utf8Reader(std::string_view buffer, FileId file = NoFile, bool ascii = false) :
+			IReader{this},
 			m_buffer(std::move(buffer)),
-			m_location{0, 1, 1},
+			m_location{0, file},
 			m_currentChar(0),
-			m_currentLength(0) {
+			m_currentLength(0),
+			m_ascii(ascii) {
 			Peek();
 		}
 
 		~Utf8Reader() override = default;
 
-		[[nodiscard]] uint32_t GetChar() const override {
+		[[nodiscard]] uint32_t GetChar() const {
 			return m_currentChar;
 		}
 
-		[[nodiscard]] Location GetLocation() const override {
+		[[nodiscard]] Location GetLocation() const {
 			return m_location;
 		}
 
-		[[nodiscard]] std::string_view Sub(Range const& range) const override {
+		[[nodiscard]] std::string_view Sub(Range const& range) const {
 			return m_buffer.substr(range.start.position, range.end.position - range.start.position);
 		}
 
-		bool Move() override {
-			if (m_currentChar == '\n') {
-				m_location.line++;
-				m_location.column = 0;
+		bool Move() {
+			if (m_currentLength == 0) {
+				return false;
 			}
-			m_location.column++;
 			m_location.position += m_currentLength;
 			Peek();
-
-			return m_currentLength > 0;
+			return true;
 		}
 
-		void SetLocation(Location location) override {
-			if (location.position < m_buffer.size()) {
-				m_location = location;
+		// only the position is taken, locations of the token stream do not know the file
+		void SetLocation(Location location) {
+			if (location.position <= m_buffer.size()) {
+				m_location.position = location.position;
 				Peek();
 			}
 		}
 
+		[[nodiscard]] std::string_view GetRest() const {
+			return m_buffer.substr(m_location.position);
+		}
+
+		void Advance(size_t bytes) {
+			m_location.position += std::min(bytes, m_buffer.size() - m_location.position);
+			Peek();
+		}
+
+	protected:
+		[[nodiscard]] uint32_t DoGetChar() const override {
+			return GetChar();
+		}
+
+		[[nodiscard]] Location DoGetLocation() const override {
+			return GetLocation();
+		}
+
+		[[nodiscard]] std::string_view DoSub(Range const& range) const override {
+			return Sub(range);
+		}
+
+		bool DoMove() override {
+			return Move();
+		}
+
+		void DoSetLocation(Location location) override {
+			SetLocation(location);
+		}
+
+		[[nodiscard]] std::string_view DoGetRest() const override {
+			return GetRest();
+		}
+
+		void DoAdvance(size_t bytes) override {
+			Advance(bytes);
+		}
+
 	private:
+		// reads the character at the position, which remains unchanged
 		void Peek() {
-			m_currentChar = 0;
-			m_currentLength = 0;
-
-			if (m_location.position < m_buffer.size()) {
-				// read next utf-8 character, position remains unchanged
-				unsigned char c = m_buffer[m_location.position];
-				size_t length = 0;
-				if (c < 0x80) {
-					length = 1;
-				} else if ((m_currentChar & 0xE0) == 0xC0) {
-					length = 2;
-				} else if ((m_currentChar & 0xF0) == 0xE0) {
-					length = 3;
-				} else if ((m_currentChar & 0xF8) == 0xF0) {
-					length = 4;
-				}
-				if (length > 0 && m_location.position + length <= m_buffer.size()) {
-					m_currentLength = length;
-					m_currentChar = c;
-					for (size_t i = 1; i < m_currentLength; ++i) {
-						m_currentChar = (m_currentChar << 6) | (m_buffer[m_location.position + i] & 0x3F);
-					}
-				}
+			if (m_ascii) {
+				bool more = m_location.position < m_buffer.size();
+				m_currentLength = more;
+				m_currentChar = more ? static_cast<unsigned char>(m_buffer[m_location.position]) : 0;
+			} else {
+				m_currentChar = Utf8::Decode(m_buffer, m_location.position, m_currentLength);
 			}
 		}
 	};
+
+	inline uint32_t IReader::GetChar() const {
+		return m_utf8 ? m_utf8->GetChar() : DoGetChar();
+	}
+
+	inline Location IReader::GetLocation() const {
+		return m_utf8 ? m_utf8->GetLocation() : DoGetLocation();
+	}
+
+	inline std::string_view IReader::Sub(Range const& range) const {
+		return m_utf8 ? m_utf8->Sub(range) : DoSub(range);
+	}
+
+	inline bool IReader::Move() {
+		return m_utf8 ? m_utf8->Move() : DoMove();
+	}
+
+	inline void IReader::SetLocation(Location location) {
+		if (m_utf8) {
+			m_utf8->SetLocation(location);
+		} else {
+			DoSetLocation(location);
+		}
+	}
+
+	inline std::string_view IReader::GetRest() const {
+		return m_utf8 ? m_utf8->GetRest() : DoGetRest();
+	}
+
+	inline void IReader::Advance(size_t bytes) {
+		if (m_utf8) {
+			m_utf8->Advance(bytes);
+		} else {
+			DoAdvance(bytes);
+		}
+	}
 }
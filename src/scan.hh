@@ -0,0 +1,238 @@
+#pragma once
+
+#include "_external.hh"
+
+#if defined(__AVX2__)
+#define FUNCC_SCAN_WIDTH 32
+#elif defined(__SSE2__) || defined(_M_X64)
+#define FUNCC_SCAN_WIDTH 16
+#endif
+
+namespace funcc {
+	// Byte search kernels for the long runs inside trivia and literals. Each returns the offset of the first byte it
+	// looks for, or the size of the text when there is none. Blocks of 32 (AVX2) or 16 (SSE2) bytes are tested at once
+	// and whatever is left byte by byte, which is all other targets do.
+	class Scan {
+#if FUNCC_SCAN_WIDTH == 32
+		using Vector = __m256i;
+		using Mask = uint32_t;
+		constexpr static size_t Width = 32;
+
+		static Vector Load(char const* p) {
+			return _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p));
+		}
+
+		static Mask Equal(Vector v, char c) {
+			return static_cast<Mask>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(c))));
+		}
+
+		// bytes with the high bit set
+		static Mask High(Vector v) {
+			return static_cast<Mask>(_mm256_movemask_epi8(v));
+		}
+
+		// unsigned low <= byte <= high
+		static Mask Between(Vector v, char low, char high) {
+			Vector offset = _mm256_sub_epi8(v, _mm256_set1_epi8(low));
+			Vector clamped = _mm256_min_epu8(offset, _mm256_set1_epi8(static_cast<char>(high - low)));
+			return static_cast<Mask>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(offset, clamped)));
+		}
+#elif FUNCC_SCAN_WIDTH == 16
+		using Vector = __m128i;
+		using Mask = uint32_t;
+		constexpr static size_t Width = 16;
+
+		static Vector Load(char const* p) {
+			return _mm_loadu_si128(reinterpret_cast<__m128i const*>(p));
+		}
+
+		static Mask Equal(Vector v, char c) {
+			return static_cast<Mask>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(c))));
+		}
+
+		// bytes with the high bit set
+		static Mask High(Vector v) {
+			return static_cast<Mask>(_mm_movemask_epi8(v));
+		}
+
+		// unsigned low <= byte <= high
+		static Mask Between(Vector v, char low, char high) {
+			Vector offset = _mm_sub_epi8(v, _mm_set1_epi8(low));
+			Vector clamped = _mm_min_epu8(offset, _mm_set1_epi8(static_cast<char>(high - low)));
+			return static_cast<Mask>(_mm_movemask_epi8(_mm_cmpeq_epi8(offset, clamped)));
+		}
+#endif
+
+	public:
+		// the first byte std::isspace rejects
+		[[nodiscard]] static size_t NonSpace(std::string_view text) {
+			size_t i = 0;
+#ifdef FUNCC_SCAN_WIDTH
+			constexpr Mask all = Width == 32 ? ~Mask{0} : (Mask{1} << Width) - 1;
+			for (; i + Width <= text.size(); i += Width) {
+				Vector v = Load(text.data() + i);
+				Mask space = Equal(v, ' ') | Between(v, '\t', '\r');
+				if (space != all) {
+					return i + Ctz(~space & all);
+				}
+			}
+#endif
+			for (; i < text.size(); ++i) {
+				if (!IsSpace(text[i])) {
+					return i;
+				}
+			}
+			return text.size();
+		}
+
+		[[nodiscard]] static size_t Byte(std::string_view text, char c) {
+			size_t i = 0;
+#ifdef FUNCC_SCAN_WIDTH
+			for (; i + Width <= text.size(); i += Width) {
+				if (Mask found = Equal(Load(text.data() + i), c)) {
+					return i + Ctz(found);
+				}
+			}
+#endif
+			for (; i < text.size(); ++i) {
+				if (text[i] == c) {
+					return i;
+				}
+			}
+			return text.size();
+		}
+
+		[[nodiscard]] static size_t EitherByte(std::string_view text, char a, char b) {
+			size_t i = 0;
+#ifdef FUNCC_SCAN_WIDTH
+			for (; i + Width <= text.size(); i += Width) {
+				Vector v = Load(text.data() + i);
+				if (Mask found = Equal(v, a) | Equal(v, b)) {
+					return i + Ctz(found);
+				}
+			}
+#endif
+			for (; i < text.size(); ++i) {
+				if (text[i] == a || text[i] == b) {
+					return i;
+				}
+			}
+			return text.size();
+		}
+
+		// the first byte past 0x7F
+		[[nodiscard]] static size_t NonAscii(std::string_view text) {
+			size_t i = 0;
+#ifdef FUNCC_SCAN_WIDTH
+			for (; i + Width <= text.size(); i += Width) {
+				if (Mask found = High(Load(text.data() + i))) {
+					return i + Ctz(found);
+				}
+			}
+#endif
+			for (; i < text.size(); ++i) {
+				if (static_cast<unsigned char>(text[i]) >= 0x80) {
+					return i;
+				}
+			}
+			return text.size();
+		}
+
+		// number of times the byte occurs
+		[[nodiscard]] static size_t Count(std::string_view text, char c) {
+			size_t count = 0;
+			size_t i = 0;
+#ifdef FUNCC_SCAN_WIDTH
+			for (; i + Width <= text.size(); i += Width) {
+				count += Popcount(Equal(Load(text.data() + i), c));
+			}
+#endif
+			for (; i < text.size(); ++i) {
+				count += text[i] == c;
+			}
+			return count;
+		}
+
+		// number of UTF-8 characters, every byte but the continuation bytes starts one
+		[[nodiscard]] static size_t Characters(std::string_view text) {
+			size_t continuations = 0;
+			size_t i = 0;
+#ifdef FUNCC_SCAN_WIDTH
+			for (; i + Width <= text.size(); i += Width) {
+				continuations += Popcount(Between(Load(text.data() + i), '\x80', '\xBF'));
+			}
+#endif
+			for (; i < text.size(); ++i) {
+				continuations += (static_cast<unsigned char>(text[i]) & 0xC0) == 0x80;
+			}
+			return text.size() - continuations;
+		}
+
+		// ASCII class of the given characters, for While and IReader::SkipWhile
+		[[nodiscard]] static std::bitset<256> Class(std::string_view chars) {
+			std::bitset<256> ascii{};
+			for (char c: chars) {
+				if (auto byte = static_cast<unsigned char>(c); byte < 0x80) {
+					ascii.set(byte);
+				}
+			}
+			return ascii;
+		}
+
+		// the first byte outside of the ASCII class, bytes past 0x7F never belong to it
+		[[nodiscard]] static size_t While(std::string_view text, std::bitset<256> const& ascii) {
+			for (size_t i = 0; i < text.size(); ++i) {
+				auto byte = static_cast<unsigned char>(text[i]);
+				if (byte >= 0x80 || !ascii.test(byte)) {
+					return i;
+				}
+			}
+			return text.size();
+		}
+
+		// start of the first occurrence of needle, candidates are where its first two bytes match
+		[[nodiscard]] static size_t Sequence(std::string_view text, std::string_view needle) {
+			if (needle.size() < 2) {
+				return needle.empty() ? 0 : Byte(text, needle[0]);
+			}
+			size_t i = 0;
+#ifdef FUNCC_SCAN_WIDTH
+			for (; i + Width + 1 <= text.size(); i += Width) {
+				Mask found = Equal(Load(text.data() + i), needle[0]) & Equal(Load(text.data() + i + 1), needle[1]);
+				while (found) {
+					size_t at = i + Ctz(found);
+					if (text.substr(at, needle.size()) == needle) {
+						return at;
+					}
+					found &= found - 1;
+				}
+			}
+#endif
+			for (; i + needle.size() <= text.size(); ++i) {
+				if (text[i] == needle[0] && text.substr(i, needle.size()) == needle) {
+					return i;
+				}
+			}
+			return text.size();
+		}
+
+	private:
+		static bool IsSpace(char c) {
+			return c == ' ' || (c >= '\t' && c <= '\r');
+		}
+
+		static size_t Popcount(uint32_t mask) {
+			return std::bitset<32>{mask}.count();
+		}
+
+		static size_t Ctz(uint32_t mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+			unsigned long index = 0;
+			_BitScanForward(&index, mask);
+			return index;
+#else
+			return static_cast<size_t>(__builtin_ctz(mask));
+#endif
+		}
+	};
+}
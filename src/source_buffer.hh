@@ -0,0 +1,130 @@
+#pragma once
+
+#include "_external.hh"
+
+namespace funcc {
+	// Text of a source. A file is mapped read-only and stays mapped until the buffer is destroyed, so views into the
+	// text remain valid that long. Files that cannot be mapped, as pipes or empty files, are read in one go instead.
+	class SourceBuffer {
+		char const* m_view{nullptr};
+		size_t m_size{0};
+		std::string m_text{};
+
+	public:
+		SourceBuffer() = default;
+
+		SourceBuffer(SourceBuffer const&) = delete;
+		SourceBuffer& operator=(SourceBuffer const&) = delete;
+
+		~SourceBuffer() {
+			Unmap();
+		}
+
+		void Assign(std::string text) {
+			Unmap();
+			m_text = std::move(text);
+		}
+
+		// false when the file cannot be opened or read
+		bool Load(std::string const& path) {
+			Unmap();
+			m_text.clear();
+			return Map(path) || Read(path);
+		}
+
+		[[nodiscard]] std::string_view GetText() const {
+			return m_view ? std::string_view{m_view, m_size} : std::string_view{m_text};
+		}
+
+	private:
+#if defined(_WIN32)
+		bool Map(std::string const& path) {
+			HANDLE file = CreateFileA(
+				path.c_str(),
+				GENERIC_READ,
+				FILE_SHARE_READ,
+				nullptr,
+				OPEN_EXISTING,
+				FILE_ATTRIBUTE_NORMAL,
+				nullptr
+			);
+			if (file == INVALID_HANDLE_VALUE) {
+				return false;
+			}
+			LARGE_INTEGER size{};
+			if (GetFileType(file) != FILE_TYPE_DISK || !GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+				CloseHandle(file);
+				return false;
+			}
+			// the view keeps the mapping and the file open
+			HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			CloseHandle(file);
+			if (!mapping) {
+				return false;
+			}
+			void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			CloseHandle(mapping);
+			if (!view) {
+				return false;
+			}
+			m_view = static_cast<char const*>(view);
+			m_size = static_cast<size_t>(size.QuadPart);
+			return true;
+		}
+
+		void Unmap() {
+			if (m_view) {
+				UnmapViewOfFile(m_view);
+				m_view = nullptr;
+			}
+		}
+#elif defined(__unix__) || defined(__APPLE__)
+		bool Map(std::string const& path) {
+			int file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+			if (file < 0) {
+				return false;
+			}
+			struct stat info{};
+			if (fstat(file, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size == 0) {
+				close(file);
+				return false;
+			}
+			// the mapping keeps the file open
+			void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+			close(file);
+			if (view == MAP_FAILED) {
+				return false;
+			}
+			m_view = static_cast<char const*>(view);
+			m_size = static_cast<size_t>(info.st_size);
+			return true;
+		}
+
+		void Unmap() {
+			if (m_view) {
+				munmap(const_cast<char*>(m_view), m_size);
+				m_view = nullptr;
+			}
+		}
+#else
+		bool Map(std::string const&) {
+			return false;
+		}
+
+		void Unmap() {}
+#endif
+
+		// reads blocks until the end, the size of a pipe is not known up front
+		bool Read(std::string const& path) {
+			std::ifstream stream{path, std::ios::binary};
+			if (!stream.is_open()) {
+				return false;
+			}
+			char block[64 * 1024];
+			while (stream.read(block, sizeof(block)) || stream.gcount() > 0) {
+				m_text.append(block, static_cast<size_t>(stream.gcount()));
+			}
+			return !stream.bad();
+		}
+	};
+}
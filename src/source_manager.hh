@@ -0,0 +1,127 @@
+#pragma once
+
+#include "_external.hh"
+#include "ast_common.hh"
+#include "line_index.hh"
+#include "source_buffer.hh"
+#include "utf8.hh"
+
+namespace funcc {
+	// Owns the text of every registered source and gives it a FileId, so locations and source ranges resolve to a
+	// path, line and column. Files are mapped rather than copied, views into a text such as the identifiers of an AST
+	// stay valid as long as the manager. Sources are checked for their size and for UTF-8 when they are added, the line
+	// index of a source is built when it is first needed.
+	class SourceManager {
+		struct Source {
+			std::string path;
+			SourceBuffer buffer{};
+			std::string_view content{};
+			bool ascii{false};
+			bool tooLarge{false};
+			size_t invalid{Utf8::Valid};
+			std::once_flag once{};
+			std::unique_ptr<LineIndex> lines{};
+		};
+
+		std::vector<std::unique_ptr<Source>> m_sources{};
+		// files holding several sources, as bundles
+		std::vector<std::unique_ptr<SourceBuffer>> m_shared{};
+
+	public:
+		// locations hold 32 bit offsets, no source may be longer
+		constexpr static size_t MaxSize = UINT32_MAX;
+
+		SourceManager() = default;
+
+		SourceManager(SourceManager const&) = delete;
+		SourceManager& operator=(SourceManager const&) = delete;
+
+		~SourceManager() = default;
+
+		// a source that is not backed by a file
+		FileId Add(std::string path, std::string content) {
+			FileId file = Reserve(std::move(path));
+			Source& source = Get(file);
+			source.buffer.Assign(std::move(content));
+			Check(source, source.buffer.GetText());
+			return file;
+		}
+
+		// an id for the file at the path, which is empty until Load reads it
+		FileId Reserve(std::string path) {
+			auto source = std::make_unique<Source>();
+			source->path = std::move(path);
+			m_sources.push_back(std::move(source));
+			return static_cast<FileId>(m_sources.size());
+		}
+
+		// Reads a reserved file, false if it cannot be read. Several threads may load different files at once as long
+		// as no source is added meanwhile.
+		bool Load(FileId file) {
+			Source& source = Get(file);
+			if (!source.buffer.Load(source.path)) {
+				return false;
+			}
+			Check(source, source.buffer.GetText());
+			return true;
+		}
+
+		// Maps a file that holds several sources and keeps it as long as the manager, false if it cannot be read.
+		// Its sources are reserved and loaded as views into outText.
+		bool LoadShared(std::string const& path, std::string_view& outText) {
+			auto buffer = std::make_unique<SourceBuffer>();
+			if (!buffer->Load(path)) {
+				return false;
+			}
+			outText = buffer->GetText();
+			m_shared.push_back(std::move(buffer));
+			return true;
+		}
+
+		// a reserved source whose text the manager keeps already, may run on several threads like Load
+		void Load(FileId file, std::string_view text) {
+			Check(Get(file), text);
+		}
+
+		[[nodiscard]] std::string_view GetPath(FileId file) const {
+			return Get(file).path;
+		}
+
+		[[nodiscard]] std::string_view GetContent(FileId file) const {
+			return Get(file).content;
+		}
+
+		// the source has no byte past 0x7F, readers need not decode it
+		[[nodiscard]] bool IsAscii(FileId file) const {
+			return Get(file).ascii;
+		}
+
+		// the source is longer than MaxSize, its content is left empty
+		[[nodiscard]] bool IsTooLarge(FileId file) const {
+			return Get(file).tooLarge;
+		}
+
+		// offset of the first byte that is not valid UTF-8, Utf8::Valid if there is none
+		[[nodiscard]] size_t GetInvalidUtf8(FileId file) const {
+			return Get(file).invalid;
+		}
+
+		[[nodiscard]] LineColumn Resolve(Location location) const {
+			Source& source = Get(location.file);
+			std::call_once(source.once, [&source]() { source.lines = std::make_unique<LineIndex>(source.content); });
+			return source.lines->Resolve(location);
+		}
+
+	private:
+		static void Check(Source& source, std::string_view content) {
+			source.tooLarge = content.size() > MaxSize;
+			source.content = source.tooLarge ? std::string_view{} : content;
+			source.ascii = Scan::NonAscii(source.content) == source.content.size();
+			source.invalid = source.ascii ? Utf8::Valid : Utf8::Validate(source.content);
+		}
+
+		[[nodiscard]] Source& Get(FileId file) const {
+			return *m_sources[file - 1];
+		}
+	};
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include "_external.hh"
+
+namespace funcc {
+	// A name interned in the process wide SymbolTable. Equal names are equal symbols, so names compare and hash as
+	// integers and their text is only looked up when it is needed.
+	class Symbol {
+		uint32_t m_id;
+
+	public:
+		constexpr static uint32_t NoId = UINT32_MAX;
+
+		// no name, as in an optional name that was not given
+		constexpr Symbol() :
+			m_id{NoId} {}
+
+		constexpr explicit Symbol(uint32_t id) :
+			m_id{id} {}
+
+		[[nodiscard]] static Symbol Intern(std::string_view text);
+
+		[[nodiscard]] constexpr uint32_t GetId() const {
+			return m_id;
+		}
+
+		[[nodiscard]] constexpr bool IsEmpty() const {
+			return m_id == NoId;
+		}
+
+		// empty for the empty symbol
+		[[nodiscard]] std::string_view GetText() const;
+
+		constexpr bool operator==(Symbol other) const {
+			return m_id == other.m_id;
+		}
+
+		constexpr bool operator!=(Symbol other) const {
+			return m_id != other.m_id;
+		}
+
+		constexpr bool operator<(Symbol other) const {
+			return m_id < other.m_id;
+		}
+	};
+
+	// Gives every distinct text a dense id from 0 and keeps the text in blocks of its own, so ids stay valid after the
+	// sources they were read from are gone. Any thread may intern and look up texts.
+	class SymbolTable {
+		constexpr static size_t BlockSize = 64 * 1024;
+
+		mutable std::shared_mutex m_mutex{};
+		std::vector<std::unique_ptr<char[]>> m_blocks{};
+		char* m_next{nullptr};
+		size_t m_left{0};
+		std::unordered_map<std::string_view, uint32_t> m_ids{};
+		std::vector<std::string_view> m_texts{};
+
+	public:
+		SymbolTable() = default;
+
+		SymbolTable(SymbolTable const&) = delete;
+		SymbolTable& operator=(SymbolTable const&) = delete;
+
+		~SymbolTable() = default;
+
+		// the table of every Symbol
+		[[nodiscard]] static SymbolTable& Global() {
+			static SymbolTable table{};
+			return table;
+		}
+
+		uint32_t Intern(std::string_view text) {
+			{
+				std::shared_lock<std::shared_mutex> lock{m_mutex};
+				if (auto it = m_ids.find(text); it != m_ids.end()) {
+					return it->second;
+				}
+			}
+			std::unique_lock<std::shared_mutex> lock{m_mutex};
+			if (auto it = m_ids.find(text); it != m_ids.end()) {
+				return it->second;
+			}
+			std::string_view stored = Store(text);
+			auto id = static_cast<uint32_t>(m_texts.size());
+			m_texts.push_back(stored);
+			m_ids.emplace(stored, id);
+			return id;
+		}
+
+		[[nodiscard]] std::string_view GetText(uint32_t id) const {
+			std::shared_lock<std::shared_mutex> lock{m_mutex};
+			return m_texts[id];
+		}
+
+		[[nodiscard]] size_t GetCount() const {
+			std::shared_lock<std::shared_mutex> lock{m_mutex};
+			return m_texts.size();
+		}
+
+	private:
+		// texts are packed into blocks, one longer than a block gets a block of its own
+		std::string_view Store(std::string_view text) {
+			if (text.size() > m_left) {
+				size_t size = std::max(BlockSize, text.size());
+				m_blocks.push_back(std::make_unique<char[]>(size));
+				m_next = m_blocks.back().get();
+				m_left = size;
+			}
+			std::copy(text.begin(), text.end(), m_next);
+			std::string_view stored{m_next, text.size()};
+			m_next += text.size();
+			m_left -= text.size();
+			return stored;
+		}
+	};
+
+	// A thread remembers the names it has interned, so it takes the table lock only for names new to it. The keys
+	// point into the global table, which outlives every thread.
+	inline Symbol Symbol::Intern(std::string_view text) {
+		thread_local std::unordered_map<std::string_view, uint32_t> seen{};
+		if (auto it = seen.find(text); it != seen.end()) {
+			return Symbol{it->second};
+		}
+		SymbolTable& table = SymbolTable::Global();
+		uint32_t id = table.Intern(text);
+		seen.emplace(table.GetText(id), id);
+		return Symbol{id};
+	}
+
+	inline std::string_view Symbol::GetText() const {
+		return IsEmpty() ? std::string_view{} : SymbolTable::Global().GetText(m_id);
+	}
+}
+
+template<>
+struct std::hash<funcc::Symbol> {
+	size_t operator()(funcc::Symbol symbol) const noexcept {
+		return std::hash<uint32_t>{}(symbol.GetId());
+	}
+};
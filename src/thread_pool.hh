@@ -0,0 +1,87 @@
+#pragma once
+
+#include "_external.hh"
+
+namespace funcc {
+	// Runs one job per index on a fixed number of threads, the calling thread being one of them. The indices are dealt
+	// out to per worker queues up front; a worker takes its own from the front and, once they are done, steals from
+	// the back of the others' queues. Jobs that are expected to take longest should come first.
+	class ThreadPool {
+		struct Queue {
+			std::mutex mutex{};
+			std::deque<size_t> jobs{};
+		};
+
+		size_t m_threads;
+
+	public:
+		// 0 threads run one worker per hardware thread
+		explicit ThreadPool(size_t threads = 0) :
+			m_threads{threads > 0 ? threads : std::max<size_t>(1, std::thread::hardware_concurrency())} {}
+
+		~ThreadPool() = default;
+
+		[[nodiscard]] size_t GetThreads() const {
+			return m_threads;
+		}
+
+		// Calls job(index) once for each index of order and returns when all calls have, jobs must not throw. The calls
+		// run in no fixed order, jobs that produce results should store them by their index.
+		template<typename F>
+		void ForEach(std::vector<size_t> const& order, F&& job) const {
+			size_t workers = std::min(m_threads, order.size());
+			if (workers <= 1) {
+				for (size_t index: order) {
+					job(index);
+				}
+				return;
+			}
+
+			std::vector<Queue> queues(workers);
+			for (size_t i = 0; i < order.size(); ++i) {
+				queues[i % workers].jobs.push_back(order[i]);
+			}
+
+			// no job is added later, a worker that finds every queue empty is done
+			auto work = [&queues, &job, workers](size_t self) {
+				size_t index = 0;
+				while (true) {
+					bool found = Take(queues[self], true, index);
+					for (size_t k = 1; !found && k < workers; ++k) {
+						found = Take(queues[(self + k) % workers], false, index);
+					}
+					if (!found) {
+						return;
+					}
+					job(index);
+				}
+			};
+
+			std::vector<std::thread> threads{};
+			threads.reserve(workers - 1);
+			for (size_t self = 1; self < workers; ++self) {
+				threads.emplace_back(work, self);
+			}
+			work(0);
+			for (auto& thread: threads) {
+				thread.join();
+			}
+		}
+
+	private:
+		static bool Take(Queue& queue, bool front, size_t& outIndex) {
+			std::lock_guard<std::mutex> lock{queue.mutex};
+			if (queue.jobs.empty()) {
+				return false;
+			}
+			if (front) {
+				outIndex = queue.jobs.front();
+				queue.jobs.pop_front();
+			} else {
+				outIndex = queue.jobs.back();
+				queue.jobs.pop_back();
+			}
+			return true;
+		}
+	};
+}
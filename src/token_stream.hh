@@ -0,0 +1,146 @@
+#pragma once
+
+#include "_external.hh"
+#include "ast_common.hh"
+#include "reader.hh"
+
+namespace funcc::parser {
+	class IToken;
+
+	enum class LexemeMatch {
+		// the position is not the start of a lexeme or the token is not a lexer rule, it has to be consumed as usual
+		Unknown,
+		Failed,
+		Matched
+	};
+
+	// Lexemes of a source file as parallel arrays, in source order. Every lexeme starts after a run of the trivia token
+	// and records how far each lexer rule matched from there, so the parser does not need to scan it again.
+	class TokenStream {
+	public:
+		constexpr static uint32_t NoMatch = UINT32_MAX;
+		constexpr static size_t NotFound = SIZE_MAX;
+		constexpr static uint32_t NoLexeme = UINT32_MAX;
+
+	private:
+		std::string_view m_source;
+		IToken const* m_trivia;
+		std::vector<IToken const*> m_rules;
+
+		std::vector<uint32_t> m_offsets{};
+		std::vector<uint32_t> m_lengths{};
+		// empty for lexemes of rules that are not interned
+		std::vector<Symbol> m_symbols{};
+		// match length of every rule for every lexeme, m_rules.size() entries per lexeme
+		std::vector<uint32_t> m_matches{};
+		// end of the trivia after the last lexeme
+		Location m_end{0};
+		// Lexeme index by byte, set where a lexeme and the trivia in front of it start, so both lookups are a single
+		// load. The trivia at the end of the source maps to the lexeme count.
+		std::vector<uint32_t> m_byByte;
+
+		std::unordered_map<std::string_view, Symbol> m_names{};
+
+	public:
+		TokenStream(std::string_view source, IToken const* trivia, std::vector<IToken const*> rules) :
+			m_source{std::move(source)},
+			m_trivia{trivia},
+			m_rules{std::move(rules)},
+			m_byByte(m_source.size() + 1, NoLexeme) {}
+
+		~TokenStream() = default;
+
+		void Push(size_t triviaStart, Location start, uint32_t length, uint32_t const* matches, bool intern) {
+			m_byByte[triviaStart] = static_cast<uint32_t>(m_offsets.size());
+			m_byByte[start.position] = static_cast<uint32_t>(m_offsets.size());
+			m_offsets.push_back(static_cast<uint32_t>(start.position));
+			m_lengths.push_back(length);
+			m_symbols.push_back(intern ? Intern(m_source.substr(start.position, length)) : Symbol{});
+			m_matches.insert(m_matches.end(), matches, matches + m_rules.size());
+		}
+
+		void SetEnd(size_t triviaStart, Location end) {
+			m_byByte[triviaStart] = static_cast<uint32_t>(m_offsets.size());
+			m_byByte[end.position] = static_cast<uint32_t>(m_offsets.size());
+			m_end = end;
+		}
+
+		[[nodiscard]] IToken const* GetTrivia() const {
+			return m_trivia;
+		}
+
+		[[nodiscard]] std::string_view GetText(size_t index) const {
+			return m_source.substr(m_offsets[index], m_lengths[index]);
+		}
+
+		// the symbol of a lexeme matched from start to end, empty unless the lexeme was interned and the match covers
+		// all of it
+		[[nodiscard]] Symbol GetSymbol(Location start, Location end) const {
+			size_t index = Find(start.position);
+			if (index == NotFound || GetEnd(index).position != end.position) {
+				return Symbol{};
+			}
+			return m_symbols[index];
+		}
+
+		[[nodiscard]] Location GetStart(size_t index) const {
+			return Location{m_offsets[index]};
+		}
+
+		[[nodiscard]] Location GetEnd(size_t index) const {
+			return Location{m_offsets[index] + size_t{m_lengths[index]}};
+		}
+
+		// index of the lexeme starting at the position
+		[[nodiscard]] size_t Find(size_t position) const {
+			uint32_t index = m_byByte[position];
+			if (index >= m_offsets.size() || m_offsets[index] != position) {
+				return NotFound;
+			}
+			return index;
+		}
+
+		// Moves the reader over the trivia when it stands where the lexer started a trivia run. Returns false if the
+		// position is anywhere else, then the trivia has to be consumed as usual.
+		bool SkipTrivia(IReader& reader) const {
+			size_t position = reader.GetLocation().position;
+			uint32_t index = m_byByte[position];
+			if (index == NoLexeme) {
+				return false;
+			}
+			Location end = index < m_offsets.size() ? GetStart(index) : m_end;
+			if (end.position != position) {
+				reader.SetLocation(end);
+			}
+			return true;
+		}
+
+		// result of the rule at the start of a lexeme, outEnd is set to the end of a successful match
+		[[nodiscard]] LexemeMatch Match(IToken const* rule, Location start, Location& outEnd) const {
+			auto it = std::find(m_rules.begin(), m_rules.end(), rule);
+			if (it == m_rules.end()) {
+				return LexemeMatch::Unknown;
+			}
+			size_t index = Find(start.position);
+			if (index == NotFound) {
+				return LexemeMatch::Unknown;
+			}
+			uint32_t length = m_matches[index * m_rules.size() + (it - m_rules.begin())];
+			if (length == NoMatch) {
+				return LexemeMatch::Failed;
+			}
+			outEnd = Location{start.position + length, start.file};
+			return LexemeMatch::Matched;
+		}
+
+	private:
+		// each distinct text of the stream goes to the symbol table once
+		Symbol Intern(std::string_view text) {
+			auto [it, added] = m_names.try_emplace(text);
+			if (added) {
+				it->second = Symbol::Intern(text);
+			}
+			return it->second;
+		}
+	};
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "_external.hh"
+#include "scan.hh"
+
+namespace funcc {
+	// UTF-8 as RFC 3629 defines it, driven by one table indexed by the lead byte of a sequence. Sources are validated
+	// once when they are loaded, readers decode them afterwards without checking again.
+	class Utf8 {
+		struct Lead {
+			// bytes of the sequence, 0 for bytes that cannot start one
+			uint8_t length;
+			// bits of the lead byte that belong to the code point
+			uint8_t mask;
+			// range of the second byte, narrower than a continuation byte after E0, ED, F0 and F4 to rule out overlong
+			// forms, surrogates and code points past U+10FFFF
+			uint8_t low;
+			uint8_t high;
+		};
+
+		constexpr static std::array<Lead, 256> Leads = []() {
+			std::array<Lead, 256> leads{};
+			for (size_t c = 0; c < 0x80; ++c) {
+				leads[c] = Lead{1, 0x7F, 0, 0};
+			}
+			for (size_t c = 0xC2; c < 0xE0; ++c) {
+				leads[c] = Lead{2, 0x1F, 0x80, 0xBF};
+			}
+			for (size_t c = 0xE0; c < 0xF0; ++c) {
+				leads[c] = Lead{3, 0x0F, 0x80, 0xBF};
+			}
+			leads[0xE0].low = 0xA0;
+			leads[0xED].high = 0x9F;
+			for (size_t c = 0xF0; c < 0xF5; ++c) {
+				leads[c] = Lead{4, 0x07, 0x80, 0xBF};
+			}
+			leads[0xF0].low = 0x90;
+			leads[0xF4].high = 0x8F;
+			return leads;
+		}();
+
+	public:
+		constexpr static size_t Valid = SIZE_MAX;
+
+		// Offset of the first invalid sequence, Valid when there is none. The offset is where the sequence starts, its
+		// lead byte, even when a later byte or the end of the text makes it invalid, so an error points at the character
+		// rather than into it. ASCII runs are skipped a block at a time, only multibyte sequences go through the table.
+		[[nodiscard]] static size_t Validate(std::string_view text) {
+			size_t i = 0;
+			while (true) {
+				i += Scan::NonAscii(text.substr(i));
+				if (i == text.size()) {
+					return Valid;
+				}
+				Lead lead = Leads[static_cast<unsigned char>(text[i])];
+				if (lead.length == 0) {
+					return i;
+				}
+				for (size_t k = 1; k < lead.length; ++k) {
+					if (i + k == text.size()) {
+						return i;
+					}
+					auto byte = static_cast<unsigned char>(text[i + k]);
+					uint8_t low = k == 1 ? lead.low : 0x80;
+					uint8_t high = k == 1 ? lead.high : 0xBF;
+					if (byte < low || byte > high) {
+						return i;
+					}
+				}
+				i += lead.length;
+			}
+		}
+
+		// Code point starting at the offset and its length in bytes. A byte that cannot start a sequence or one cut
+		// off by the end of the text gives a length of 0, as the end of the text does.
+		static uint32_t Decode(std::string_view text, size_t offset, size_t& outLength) {
+			outLength = 0;
+			if (offset >= text.size()) {
+				return 0;
+			}
+			Lead lead = Leads[static_cast<unsigned char>(text[offset])];
+			if (lead.length == 0 || offset + lead.length > text.size()) {
+				return 0;
+			}
+			uint32_t c = static_cast<unsigned char>(text[offset]) & lead.mask;
+			for (size_t k = 1; k < lead.length; ++k) {
+				c = (c << 6) | (static_cast<unsigned char>(text[offset + k]) & 0x3F);
+			}
+			outLength = lead.length;
+			return c;
+		}
+	};
+}
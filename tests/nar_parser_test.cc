@@ -0,0 +1,297 @@
+#include "_external.hh"
+#include "nar/parser_package.hh"
+
+// Checks the values the nar grammar builds. Every source is parsed with each engine, a failed check prints the engine
+// and what was expected and the run exits with 1.
+namespace {
+	using namespace funcc::nar;
+	using Engine = PackageParser::Engine;
+	using funcc::ConstFloat;
+	using funcc::ConstInt;
+	using funcc::ConstString;
+
+	std::vector<std::pair<Engine, std::string_view>> const Engines{
+		{Engine::Tokens, "tokens"},
+		{Engine::Fixed, "fixed"},
+		{Engine::Machine, "machine"},
+	};
+
+	int failures = 0;
+
+	void Check(bool ok, std::string_view engine, std::string_view what) {
+		if (!ok) {
+			std::cerr << "FAILED [" << engine << "] " << what << std::endl;
+			++failures;
+		}
+	}
+
+	// a fresh directory under the system temp directory
+	std::filesystem::path MakeDirectory(std::string_view name) {
+		std::filesystem::path dir = std::filesystem::temp_directory_path() / "funcc_tests" / name;
+		std::filesystem::remove_all(dir);
+		std::filesystem::create_directories(dir);
+		return dir;
+	}
+
+	void WriteFile(std::filesystem::path const& path, std::string_view text) {
+		std::ofstream stream{path, std::ios::binary | std::ios::trunc};
+		stream.write(text.data(), static_cast<std::streamsize>(text.size()));
+	}
+
+	// the value of a source that is expected to parse, nullptr after a failed check
+	std::shared_ptr<funcc::parser::ITokenValue> ParseSource(
+		PackageParser& p,
+		std::string_view engine,
+		std::string_view source
+	) {
+		std::filesystem::path path = MakeDirectory("source") / "Source.nar";
+		WriteFile(path, source);
+		std::shared_ptr<funcc::parser::ITokenValue> result = p.ParseFile(path.string());
+		Check(!result->HasError(), engine, "the source parses");
+		return result->HasError() ? nullptr : result;
+	}
+
+	File const& GetFile(std::shared_ptr<funcc::parser::ITokenValue> const& value) {
+		return value->As<FileParser::FileValue>().GetValue();
+	}
+
+	void TestImportAlias() {
+		for (auto const& [engine, name]: Engines) {
+			PackageParser p{funcc::parser::MemoTable::DefaultCapacity, engine};
+			auto result = ParseSource(p, name, "module M\n\nimport Nar.Base.Maybe as B exposing (Maybe)\n");
+			if (!result) {
+				continue;
+			}
+			File const& file = GetFile(result);
+			Check(file.imports.size() == 1, name, "one import");
+			if (file.imports.size() == 1) {
+				Check(file.imports[0].alias.GetText() == "B", name, "the import is aliased as B");
+				Check(file.imports[0].expose.size() == 1, name, "the import exposes one name");
+			}
+		}
+	}
+
+	void TestDataConstructorParameters() {
+		for (auto const& [engine, name]: Engines) {
+			PackageParser p{funcc::parser::MemoTable::DefaultCapacity, engine};
+			auto result = ParseSource(p, name, "module M\n\ntype Shape[a] = | Point(x: a, y: a) | Tagged(a) | Empty\n");
+			if (!result) {
+				continue;
+			}
+			File const& file = GetFile(result);
+			Check(file.declarations.size() == 1, name, "one declaration");
+			if (file.declarations.size() != 1) {
+				continue;
+			}
+			auto const* data = dynamic_cast<Data const*>(file.declarations.front().get());
+			Check(data != nullptr, name, "the declaration is a data type");
+			if (!data) {
+				continue;
+			}
+			Check(data->GetTypeParams().size() == 1, name, "one type parameter");
+			if (data->GetTypeParams().size() == 1) {
+				Check(data->GetTypeParams()[0].GetText() == "a", name, "the type parameter is a");
+			}
+			std::vector<DataConstructor> const& constructors = data->GetConstructors();
+			Check(constructors.size() == 3, name, "three constructors");
+			if (constructors.size() != 3) {
+				continue;
+			}
+			Check(constructors[0].params.size() == 2, name, "Point has two parameters");
+			if (constructors[0].params.size() == 2) {
+				Check(constructors[0].params[0].name.GetText() == "x", name, "the first parameter of Point is x");
+				Check(constructors[0].params[1].name.GetText() == "y", name, "the second parameter of Point is y");
+			}
+			Check(constructors[1].params.size() == 1, name, "Tagged has one parameter");
+			if (constructors[1].params.size() == 1) {
+				Check(constructors[1].params[0].name.IsEmpty(), name, "the parameter of Tagged has no name");
+			}
+			Check(constructors[2].params.empty(), name, "Empty has no parameters");
+		}
+	}
+
+	// without a memo table left recursive rules still grow their seeds instead of expanding to the recursion limit
+	void TestLeftRecursionWithoutMemo() {
+		for (auto const& [engine, name]: Engines) {
+			PackageParser p{0, engine};
+			auto result = ParseSource(p, name, "module M\n\ndef x = f(a).b.c(1) + 2 * g(3)\n");
+			if (!result) {
+				continue;
+			}
+			File const& file = GetFile(result);
+			Check(file.declarations.size() == 1, name, "one declaration");
+		}
+	}
+
+	// parses a source of one definition `def x = <literal>` and checks the constant it binds
+	template <typename C, typename V>
+	void CheckLiteral(PackageParser& p, std::string_view engine, std::string const& literal, V expected) {
+		auto result = ParseSource(p, engine, "module M\n\ndef x = " + literal + "\n");
+		if (!result) {
+			return;
+		}
+		File const& file = GetFile(result);
+		auto const* function = file.declarations.size() == 1
+			? dynamic_cast<Function const*>(file.declarations.front().get())
+			: nullptr;
+		auto const* body = function ? dynamic_cast<ExpressionConst const*>(&function->GetBody()) : nullptr;
+		auto const* constant = body ? dynamic_cast<C const*>(&body->GetValue()) : nullptr;
+		Check(constant != nullptr, engine, literal + " is a constant of the expected type");
+		Check(!constant || constant->GetValue() == expected, engine, literal + " has the expected value");
+	}
+
+	void TestNumbers() {
+		for (auto const& [engine, name]: Engines) {
+			PackageParser p{funcc::parser::MemoTable::DefaultCapacity, engine};
+			CheckLiteral<ConstInt>(p, name, "0x1F", 31);
+			CheckLiteral<ConstInt>(p, name, "0b101", 5);
+			CheckLiteral<ConstInt>(p, name, "1_000", 1000);
+			CheckLiteral<ConstInt>(p, name, "9223372036854775807", INT64_MAX);
+			CheckLiteral<ConstInt>(p, name, "-9223372036854775808", INT64_MIN);
+			CheckLiteral<ConstFloat>(p, name, "1.5e3", 1500.0);
+
+			// a literal out of range fails the file at the literal instead of reading as something else
+			std::vector<std::string> const outOfRange{
+				"9223372036854775808",
+				"-9223372036854775809",
+				"99999999999999999999",
+				"1.5e400",
+			};
+			for (std::string const& literal: outOfRange) {
+				std::filesystem::path path = MakeDirectory("source") / "Source.nar";
+				WriteFile(path, "module M\n\ndef x = " + literal + "\n");
+				std::shared_ptr<funcc::parser::ITokenValue> result = p.ParseFile(path.string());
+				Check(result->HasError(), name, literal + " is rejected");
+				if (result->HasError()) {
+					auto const& error = result->As<funcc::parser::ErrorValue>();
+					Check(error.GetMessage() == "Number out of range", name, literal + " is out of range");
+					Check(error.GetRange().start.position == 18, name, literal + " is reported where it starts");
+				}
+			}
+		}
+	}
+
+	// an invalid sequence is reported where it starts, valid text reaches the string constant unchanged
+	void TestUtf8() {
+		std::vector<std::pair<std::string, std::string_view>> const invalid{
+			{"\"h\xc3llo\"", "a truncated sequence"},
+			{"\"h\xe2\x82", "a sequence cut off by the end of the file"},
+			{"\"h\xc0\xafllo\"", "an overlong two byte form"},
+			{"\"h\xe0\x80\xafllo\"", "an overlong three byte form"},
+			{"\"h\xed\xa0\x80llo\"", "a surrogate"},
+		};
+		for (auto const& [engine, name]: Engines) {
+			PackageParser p{funcc::parser::MemoTable::DefaultCapacity, engine};
+			// two, three and four byte sequences
+			std::string text = "h\xc3\xa9llo \xe2\x82\xac \xf0\x9f\x98\x80";
+			CheckLiteral<ConstString>(p, name, "\"" + text + "\"", text);
+
+			for (auto const& [literal, what]: invalid) {
+				std::string source = "module M\n\ndef x = " + literal;
+				std::filesystem::path path = MakeDirectory("source") / "Source.nar";
+				WriteFile(path, source);
+				std::shared_ptr<funcc::parser::ITokenValue> result = p.ParseFile(path.string());
+				Check(result->HasError(), name, std::string(what) + " is rejected");
+				if (result->HasError()) {
+					auto const& error = result->As<funcc::parser::ErrorValue>();
+					Check(error.GetMessage() == "Invalid UTF-8", name, std::string(what) + " is invalid UTF-8");
+					Check(
+						error.GetRange().start.position == source.find('h') + 1,
+						name,
+						std::string(what) + " is reported at its lead byte"
+					);
+				}
+			}
+		}
+	}
+
+	// the outcome of every file in result order, errors with their message and offset
+	std::vector<std::string> Describe(std::vector<PackageParser::PackageFile> const& files, bool withPaths) {
+		std::vector<std::string> lines{};
+		for (auto const& file: files) {
+			std::string line = withPaths ? file.path + " " : std::string{};
+			if (file.result->HasError()) {
+				auto const& error = file.result->As<funcc::parser::ErrorValue>();
+				line += std::to_string(error.GetRange().start.position) + " " + error.GetMessage();
+			} else {
+				line += "ok";
+			}
+			lines.push_back(std::move(line));
+		}
+		return lines;
+	}
+
+	// the results of a package come back in path order however the files were scheduled
+	void TestPackageOrder() {
+		std::filesystem::path root = MakeDirectory("package");
+		for (int i = 0; i < 24; ++i) {
+			std::filesystem::path dir = root / (i % 3 == 0 ? "a" : i % 3 == 1 ? "b/c" : "");
+			std::filesystem::create_directories(dir);
+			// every other file fails, each at a different offset
+			std::string source = "module M\n\ndef x = " + std::string(static_cast<size_t>(i), ' ');
+			source += i % 2 == 0 ? "f(1)\n" : ")\n";
+			WriteFile(dir / ("M" + std::to_string(i * 7 % 24) + ".nar"), source);
+		}
+		std::filesystem::path bundle = MakeDirectory("bundle") / "package.bundle";
+
+		for (auto const& [engine, name]: Engines) {
+			PackageParser p{funcc::parser::MemoTable::DefaultCapacity, engine};
+			std::vector<PackageParser::PackageFile> files = p.ParsePackage(root.string(), 1);
+			Check(files.size() == 24, name, "every file of the package is parsed");
+			Check(
+				std::is_sorted(
+					files.begin(),
+					files.end(),
+					[](auto const& a, auto const& b) { return a.path < b.path; }
+				),
+				name,
+				"the results are sorted by path"
+			);
+			funcc::parser::MemoStats sum{};
+			for (auto const& file: files) {
+				sum.hits += file.stats.hits;
+				sum.misses += file.stats.misses;
+				sum.evictions += file.stats.evictions;
+			}
+			Check(files.front().stats.misses > 0, name, "every file keeps the stats of its own memo table");
+			Check(
+				sum.hits == p.GetMemoStats().hits && sum.misses == p.GetMemoStats().misses &&
+					sum.evictions == p.GetMemoStats().evictions,
+				name,
+				"the memo stats of the package are the sum of the stats of its files"
+			);
+			std::vector<std::string> expected = Describe(files, true);
+			for (size_t threads: {2, 4, 8}) {
+				for (int round = 0; round < 4; ++round) {
+					Check(
+						Describe(p.ParsePackage(root.string(), threads), true) == expected,
+						name,
+						"the results do not depend on the number of threads"
+					);
+				}
+			}
+
+			Check(!p.WriteBundle(root.string(), bundle.string()), name, "the package is written to a bundle");
+			Check(
+				Describe(p.ParseBundle(bundle.string(), 4), false) == Describe(files, false),
+				name,
+				"the bundle gives the results of the directory in the same order"
+			);
+		}
+	}
+}
+
+int main() {
+	TestImportAlias();
+	TestDataConstructorParameters();
+	TestLeftRecursionWithoutMemo();
+	TestNumbers();
+	TestUtf8();
+	TestPackageOrder();
+	if (failures > 0) {
+		std::cerr << failures << " checks failed" << std::endl;
+		return 1;
+	}
+	std::cout << "All checks passed" << std::endl;
+	return 0;
+}